@@ -5,6 +5,9 @@ const platform = @import("src/utils/platform.zig");
 pub fn build(b: *std.Build) void {
     const target = b.standardTargetOptions(.{});
     const optimize = b.standardOptimizeOption(.{});
+
+    const build_options = b.addOptions();
+    build_options.addOption(bool, "dispatch_profiling", b.option(bool, "dispatch-profiling", "Record per-handler timing in event dispatchers") orelse false);
     const mod = b.addModule("glaze", .{
         .root_source_file = b.path("src/root.zig"),
         .target = target,
@@ -51,7 +54,12 @@ pub fn build(b: *std.Build) void {
     });
 
     exe.root_module.addImport("zigimg", zigimg_dependency.module("zigimg"));
-    
+    exe.root_module.addOptions("build_options", build_options);
+
+    // Exported module reaches the same sources, so consumers need the same imports
+    mod.addImport("zigimg", zigimg_dependency.module("zigimg"));
+    mod.addOptions("build_options", build_options);
+
     exe.linkLibC();
     b.installArtifact(exe);
 
@@ -63,4 +71,24 @@ pub fn build(b: *std.Build) void {
     if (b.args) |args| {
         run_cmd.addArgs(args);
     }
+
+    // Decodes textures ahead of time so the game can upload them straight from cache
+    const cook_exe = b.addExecutable(.{
+        .name = "cook-textures",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("src/cook-textures.zig"),
+            .target = target,
+            .optimize = optimize,
+        }),
+    });
+    cook_exe.root_module.addImport("zigimg", zigimg_dependency.module("zigimg"));
+
+    const cook_step = b.step("cook", "Cook textures into GPU ready cache");
+    const cook_cmd = b.addRunArtifact(cook_exe);
+    cook_cmd.setCwd(b.path("."));
+    cook_step.dependOn(&cook_cmd.step);
+
+    if (b.args) |args| {
+        cook_cmd.addArgs(args);
+    }
 }
@@ -1,5 +1,6 @@
 const GameObject = @import("../scene-manager/game_object.zig").GameObject;
 const Transform = @import("transform.zig").Transform;
+const Renderer = @import("../renderer/renderer.zig").Renderer;
 
 pub const Camera2D = struct {
     game_object: ?*GameObject = null,
@@ -11,6 +12,11 @@ pub const Camera2D = struct {
         ptr.* = Camera2D{};
     }
 
+    pub fn setZoom(self: *Camera2D, zoom: f32) void {
+        self.zoom = zoom;
+        Renderer.requestRedraw();
+    }
+
     pub fn makeViewMatrix(self: *Camera2D) [16]f32 {
         if (self.transform == null) {
             self.transform = self.game_object.?.getComponent(Transform);
@@ -1,50 +1,99 @@
 const std = @import("std");
-const typeId = @import("../utils/type-id.zig").typeId;
 
 const Renderer = @import("../renderer/renderer.zig").Renderer;
 const GameObject = @import("../scene-manager/game_object.zig").GameObject;
 const Material = @import("../materials/material.zig").Material;
+const material_instance = @import("../materials/material-instance.zig");
+const MaterialInstance = material_instance.MaterialInstance;
+const ParamBlock = material_instance.ParamBlock;
 const StandardMaterial = @import("../materials/standard-material.zig").StandardMaterial;
 const Vector4 = @import("../vectors/vector4.zig").Vector4;
+const TextureHandle = @import("../textures/texture-manager.zig").TextureHandle;
 
-pub fn SpriteRenderer(comptime spritePath: []const u8) type {
-    return struct {
-        game_object: ?*GameObject = null,
-        material: ?*Material = null,
-        sprite_path: []const u8 = spritePath,
+/// Setters request a redraw, see `Renderer.setIdleMode()`. Fields written directly are not noticed by idle frame skipping.
+pub const SpriteRenderer = struct {
+    game_object: ?*GameObject = null,
+    material: ?*MaterialInstance = null, // Resolved from `params` by the renderer's build stage
+    get_base_material: *const fn () anyerror!*Material = getMaterialOf(StandardMaterial),
+    params: ParamBlock = ParamBlock.empty,
+    texture: ?TextureHandle = null, // Sprite is drawn untextured without one
 
-        color: *[4]f32,
+    color: [4]f32 = .{ 1.0, 1.0, 1.0, 1.0 },
+    layer: u8 = 0, // Sprites in higher layers are drawn on top, see `makeSortKey()`
 
-        const Self = @This();
+    pub fn create(ptr: *SpriteRenderer) !void {
+        ptr.* = SpriteRenderer{};
+    }
 
-        pub fn create(ptr: *Self) !void {
-            const color = try std.heap.c_allocator.create([4]f32);
-            color.* = [4]f32{ 1.0, 1.0, 1.0, 1.0 };
+    pub fn destroy(self: *SpriteRenderer) !void {
+        self.clearTexture();
+    }
 
-            ptr.* = Self{
-                .color = color,
-            };
+    /// Material instance sprite is drawn with, created on first use. Its program is linked on the render thread when first drawn.
+    pub fn getMaterial(self: *SpriteRenderer) !*MaterialInstance {
+        if (self.material == null) {
+            const base = try self.get_base_material();
+            self.material = try Renderer.cacheMaterialInstance(base, &self.params);
         }
 
-        pub fn getMaterial(self: *Self) !*Material {
-            if (self.material == null) {
-                const cache = try Renderer.cacheMaterial(StandardMaterial);
-                self.material = cache.material;
-            }
+        return self.material.?;
+    }
 
-            return self.material.?;
-        }
+    /// Draws sprite with `TMaterial`, e.g. `CutoutMaterial`. Material is created when sprite is next recorded.
+    pub fn setMaterial(self: *SpriteRenderer, comptime TMaterial: type) void {
+        self.get_base_material = getMaterialOf(TMaterial);
+        self.material = null;
+        Renderer.requestRedraw();
+    }
 
-        pub fn getSpriteTexture(self: *Self) ?u32 {
-            return Renderer.cacheTexture(self.sprite_path) catch null;
-        }
+    /// Sets uniforms of sprite's material, see `ParamBlock.from()`.
+    /// Sprites with equal parameters share a material instance and are still drawn in one batch.
+    pub fn setMaterialParams(self: *SpriteRenderer, values: anytype) void {
+        self.params = ParamBlock.from(values);
+        self.material = null;
+        Renderer.requestRedraw();
+    }
 
-        pub fn setColor(self: *Self, color: *Vector4) void {
-            self.color.* = color.toArray();
-        }
+    /// Sets texture loaded from `path`, it is loaded in the background if it was not used before
+    pub fn setTexture(self: *SpriteRenderer, path: []const u8) !void {
+        const handle = try Renderer.acquireTexture(path);
+
+        self.clearTexture();
+        self.texture = handle;
+        Renderer.requestRedraw();
+    }
+
+    /// Sets texture from a handle, sprite takes its own reference so caller keeps theirs
+    pub fn setTextureHandle(self: *SpriteRenderer, handle: TextureHandle) void {
+        const clone = handle.clone();
 
-        pub fn getId() u32 {
-            return typeId(SpriteRenderer(""));
+        self.clearTexture();
+        self.texture = clone;
+        Renderer.requestRedraw();
+    }
+
+    pub fn clearTexture(self: *SpriteRenderer) void {
+        if (self.texture) |handle| handle.release();
+        self.texture = null;
+        Renderer.requestRedraw();
+    }
+
+    pub fn setColor(self: *SpriteRenderer, color: *Vector4) void {
+        self.color = color.toArray();
+        Renderer.requestRedraw();
+    }
+
+    pub fn setLayer(self: *SpriteRenderer, layer: u8) void {
+        self.layer = layer;
+        Renderer.requestRedraw();
+    }
+};
+
+fn getMaterialOf(comptime TMaterial: type) *const fn () anyerror!*Material {
+    return struct {
+        fn get() anyerror!*Material {
+            const cache = try Renderer.cacheMaterial(TMaterial);
+            return cache.material;
         }
-    };
+    }.get;
 }
@@ -1,6 +1,7 @@
 const std = @import("std");
 
 const GameObject = @import("../scene-manager/game_object.zig").GameObject;
+const Renderer = @import("../renderer/renderer.zig").Renderer;
 const Vector3 = @import("../vectors/vector3.zig").Vector3;
 
 pub const Transform = struct {
@@ -18,18 +19,21 @@ pub const Transform = struct {
         self.position.x = position.x;
         self.position.y = position.y;
         self.position.z = position.z;
+        Renderer.requestRedraw();
     }
 
     pub fn setRotation(self: *Transform, rotation: Vector3) void {
         self.rotation.x = rotation.x;
         self.rotation.y = rotation.y;
         self.rotation.z = rotation.z;
+        Renderer.requestRedraw();
     }
 
     pub fn setScale(self: *Transform, scale: Vector3) void {
         self.scale.x = scale.x;
         self.scale.y = scale.y;
         self.scale.z = scale.z;
+        Renderer.requestRedraw();
     }
 
     pub fn get2DMatrix(self: *const Transform) [16]f32 {
@@ -0,0 +1,63 @@
+const std = @import("std");
+
+const cooked_texture = @import("textures/cooked-texture.zig");
+
+/// Directories cooked when none are passed on the command line
+const default_source_directories = [_][]const u8{"src/assets/textures"};
+
+const image_extensions = [_][]const u8{ ".png", ".bmp", ".tga", ".qoi", ".jpg", ".jpeg" };
+
+/// Cooks every image under the given directories into `cooked_texture.cache_directory`.
+/// Paths are written the same way the game requests them, relative to working directory with `/` separators,
+/// so the cache names match at runtime. Textures that are already up to date are left alone.
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    const directories: []const []const u8 = if (args.len > 1) args[1..] else &default_source_directories;
+
+    var cooked_count: usize = 0;
+    var failed_count: usize = 0;
+
+    for (directories) |directory| {
+        var dir = try std.fs.cwd().openDir(directory, .{ .iterate = true });
+        defer dir.close();
+
+        var walker = try dir.walk(allocator);
+        defer walker.deinit();
+
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file or !isImage(entry.basename)) continue;
+
+            const path = try std.fmt.allocPrint(allocator, "{s}/{s}", .{ directory, entry.path });
+            defer allocator.free(path);
+            std.mem.replaceScalar(u8, path, '\\', '/');
+
+            var texture = cooked_texture.loadOrCook(allocator, path) catch |e| {
+                std.log.err("Failed to cook {s}: {}", .{ path, e });
+                failed_count += 1;
+                continue;
+            };
+            texture.deinit(allocator);
+
+            cooked_count += 1;
+        }
+    }
+
+    std.log.info("Cooked {} textures into {s}, {} failed", .{ cooked_count, cooked_texture.cache_directory, failed_count });
+    if (failed_count > 0) return error.CookFailed;
+}
+
+fn isImage(name: []const u8) bool {
+    const extension = std.fs.path.extension(name);
+
+    for (image_extensions) |image_extension| {
+        if (std.ascii.eqlIgnoreCase(extension, image_extension)) return true;
+    }
+
+    return false;
+}
@@ -1,8 +1,11 @@
 const std = @import("std");
 
+const App = @import("../app.zig").App;
 const FpsCounter = @import("fps-counter.zig").FpsCounter;
+const FrameStatsDumpTarget = @import("../renderer/frame-stats.zig").FrameStatsDumpTarget;
 
 var fps_counter: ?*FpsCounter = null;
+var is_frame_stats_logging: bool = false;
 
 pub const Debug = struct {
     pub fn toggleFpsLogging() void {
@@ -13,4 +16,13 @@ pub const Debug = struct {
             fps_counter = FpsCounter.init() catch return;
         }
     }
+
+    /// Prints average and peak renderer frame stats to stdout every second or so, see `Renderer.setFrameStatsDump()`
+    pub fn toggleFrameStatsLogging() void {
+        const target: FrameStatsDumpTarget = if (is_frame_stats_logging) .None else .Stdout;
+        App.get().renderer.setFrameStatsDump(target, 60) catch return;
+
+        is_frame_stats_logging = !is_frame_stats_logging;
+        if (!is_frame_stats_logging) std.debug.print("Frame stats logging disabled\n", .{});
+    }
 };
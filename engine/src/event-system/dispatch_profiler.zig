@@ -0,0 +1,169 @@
+const std = @import("std");
+const build_options = @import("build_options");
+
+/// Set with `zig build -Ddispatch-profiling=true`. When false, every profiling field is `void`
+/// and dispatch loops compile to the same code as without instrumentation.
+pub const enabled: bool = build_options.dispatch_profiling;
+
+// Histogram has 4 sub-buckets per power of two which keeps percentile error under 25%
+const sub_bucket_bits = 2;
+const sub_bucket_count = 1 << sub_bucket_bits;
+const octave_count = 40; // 2^40 ns is ~18 minutes, anything slower lands in the last bucket
+const bucket_count = octave_count * sub_bucket_count;
+
+var budget_ns = std.atomic.Value(u64).init(2 * std.time.ns_per_ms);
+
+/// Sets time a single handler call may take before it is flagged in reports
+pub fn setBudget(ns: u64) void {
+    budget_ns.store(ns, .monotonic);
+}
+
+pub fn getBudget() u64 {
+    return budget_ns.load(.monotonic);
+}
+
+/// Timing of a single handler
+pub const HandlerStats = struct {
+    call_count: u64 = 0,
+    total_ns: u64 = 0,
+    min_ns: u64 = std.math.maxInt(u64),
+    max_ns: u64 = 0,
+    over_budget_count: u64 = 0,
+    histogram: [bucket_count]u32 = .{0} ** bucket_count,
+
+    pub fn record(self: *HandlerStats, ns: u64) void {
+        self.call_count += 1;
+        self.total_ns +|= ns;
+        self.min_ns = @min(self.min_ns, ns);
+        self.max_ns = @max(self.max_ns, ns);
+
+        if (ns > getBudget()) self.over_budget_count += 1;
+
+        const index = bucketIndex(ns);
+        self.histogram[index] +|= 1;
+    }
+
+    pub fn reset(self: *HandlerStats) void {
+        self.* = HandlerStats{};
+    }
+
+    pub fn mean(self: *const HandlerStats) u64 {
+        if (self.call_count == 0) return 0;
+        return self.total_ns / self.call_count;
+    }
+
+    /// Estimates percentile from histogram
+    ///
+    /// # Arguments
+    /// - `fraction`: Percentile in range 0..1, e.g. 0.99 for p99
+    pub fn percentile(self: *const HandlerStats, fraction: f64) u64 {
+        if (self.call_count == 0) return 0;
+
+        const target: u64 = @intFromFloat(@ceil(@as(f64, @floatFromInt(self.call_count)) * fraction));
+        var cumulative: u64 = 0;
+
+        for (self.histogram, 0..) |count, index| {
+            cumulative += count;
+            if (cumulative >= target) return @min(bucketUpperBound(index), self.max_ns);
+        }
+
+        return self.max_ns;
+    }
+};
+
+/// Snapshot of a handler's stats, safe to keep after dispatcher is unlocked
+pub const HandlerReport = struct {
+    id: i64,
+    name: []const u8,
+
+    call_count: u64,
+    min_ns: u64,
+    mean_ns: u64,
+    max_ns: u64,
+    p99_ns: u64,
+    over_budget_count: u64,
+
+    pub fn fromStats(id: i64, name: []const u8, stats: *const HandlerStats) HandlerReport {
+        return HandlerReport{
+            .id = id,
+            .name = name,
+            .call_count = stats.call_count,
+            .min_ns = if (stats.call_count == 0) 0 else stats.min_ns,
+            .mean_ns = stats.mean(),
+            .max_ns = stats.max_ns,
+            .p99_ns = stats.percentile(0.99),
+            .over_budget_count = stats.over_budget_count,
+        };
+    }
+
+    fn slowerThan(_: void, a: HandlerReport, b: HandlerReport) bool {
+        return a.max_ns > b.max_ns;
+    }
+};
+
+pub fn startTiming() ?std.time.Instant {
+    return std.time.Instant.now() catch null;
+}
+
+pub fn elapsedSince(start: ?std.time.Instant) u64 {
+    const begin = start orelse return 0;
+    const end = std.time.Instant.now() catch return 0;
+    return end.since(begin);
+}
+
+/// Prints slowest handlers of a dispatcher, handlers over budget are marked with `!`
+///
+/// # Arguments
+/// - `dispatcher_name`: Name printed in report header
+/// - `reports`: Handler reports, sorted in place by max duration
+/// - `max_rows`: Maximum number of handlers to print
+pub fn printReport(dispatcher_name: []const u8, reports: []HandlerReport, max_rows: usize) void {
+    if (reports.len == 0) return;
+
+    std.mem.sort(HandlerReport, reports, {}, HandlerReport.slowerThan);
+
+    var over_budget: usize = 0;
+    for (reports) |report| {
+        if (report.over_budget_count > 0) over_budget += 1;
+    }
+
+    std.debug.print("\n--- {s}: {} handlers, {} over {}us budget ---\n", .{ dispatcher_name, reports.len, over_budget, getBudget() / std.time.ns_per_us });
+    std.debug.print("  {s:>10} {s:>10} {s:>10} {s:>10} {s:>10}  handler\n", .{ "calls", "min us", "mean us", "p99 us", "max us" });
+
+    for (reports[0..@min(max_rows, reports.len)]) |report| {
+        std.debug.print("{s} {d:>10} {d:>10.1} {d:>10.1} {d:>10.1} {d:>10.1}  {s} (#{})\n", .{
+            if (report.over_budget_count > 0) "!" else " ",
+            report.call_count,
+            nsToUs(report.min_ns),
+            nsToUs(report.mean_ns),
+            nsToUs(report.p99_ns),
+            nsToUs(report.max_ns),
+            report.name,
+            report.id,
+        });
+    }
+}
+
+// --------------------------- HELPER FUNCTIONS --------------------------- //
+fn nsToUs(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / std.time.ns_per_us;
+}
+
+fn bucketIndex(ns: u64) usize {
+    if (ns < sub_bucket_count) return @intCast(ns);
+
+    const octave: usize = 63 - @clz(ns);
+    const sub: usize = @intCast((ns >> @intCast(octave - sub_bucket_bits)) & (sub_bucket_count - 1));
+
+    return @min((octave - sub_bucket_bits + 1) * sub_bucket_count + sub, bucket_count - 1);
+}
+
+fn bucketUpperBound(index: usize) u64 {
+    if (index < sub_bucket_count) return index;
+
+    const octave = index / sub_bucket_count + sub_bucket_bits - 1;
+    const sub = index % sub_bucket_count;
+
+    const base = @as(u64, 1) << @intCast(octave - sub_bucket_bits);
+    return (sub_bucket_count + sub + 1) * base - 1;
+}
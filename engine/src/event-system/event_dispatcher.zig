@@ -6,6 +6,10 @@ const cFree = c_allocator_util.cFree;
 
 const Timer = @import("../utils/timer.zig").Timer;
 
+const dispatch_profiler = @import("dispatch_profiler.zig");
+const HandlerReport = dispatch_profiler.HandlerReport;
+const ProfilerStats = if (dispatch_profiler.enabled) dispatch_profiler.HandlerStats else void;
+
 const Allocator = std.mem.Allocator;
 const HashMap = std.AutoHashMap;
 
@@ -18,6 +22,9 @@ fn HandlerEntry(comptime TEventArg: type, comptime TEventData: type) type {
         callback: HandlerFn(TEventArg, TEventData),
         data: ?TEventData,
         is_paused: bool,
+
+        name: []const u8, // Shown in profiler reports
+        stats: ProfilerStats,
     };
 }
 
@@ -61,6 +68,11 @@ pub fn EventDispatcher(comptime TEventArg: type, comptime TEventData: type) type
         }
 
         pub fn addHandler(self: *Self, handler: Fn, data: ?TEventData) !EntryKey {
+            return try self.addNamedHandler(handler, data, "anonymous");
+        }
+
+        /// Adds handler with a name that identifies it in profiler reports
+        pub fn addNamedHandler(self: *Self, handler: Fn, data: ?TEventData, name: []const u8) !EntryKey {
             self.mutex.lock();
             defer self.mutex.unlock();
 
@@ -71,6 +83,8 @@ pub fn EventDispatcher(comptime TEventArg: type, comptime TEventData: type) type
                 .callback = handler,
                 .data = data,
                 .is_paused = false,
+                .name = name,
+                .stats = if (dispatch_profiler.enabled) dispatch_profiler.HandlerStats{} else {},
             }) catch {
                 // Decrement id if failed to prevent ghost numbers
                 self.next_id -= 1;
@@ -140,11 +154,63 @@ pub fn EventDispatcher(comptime TEventArg: type, comptime TEventData: type) type
             var it = self.entries.iterator();
 
             while (it.next()) |entry| {
-                if (!entry.value_ptr.is_paused)
+                if (entry.value_ptr.is_paused) continue;
+
+                if (comptime dispatch_profiler.enabled) {
+                    const start = dispatch_profiler.startTiming();
+                    defer entry.value_ptr.stats.record(dispatch_profiler.elapsedSince(start));
+
+                    try entry.value_ptr.callback(arg, entry.value_ptr.data);
+                } else {
                     try entry.value_ptr.callback(arg, entry.value_ptr.data);
+                }
             }
         }
 
+        //#region Profiling
+        /// Returns timing of every handler, empty unless built with `-Ddispatch-profiling=true`.
+        /// Caller owns returned slice.
+        pub fn getHandlerReports(self: *Self, allocator: Allocator) ![]HandlerReport {
+            if (comptime !dispatch_profiler.enabled) return &.{};
+
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            const reports = try allocator.alloc(HandlerReport, self.entries.count());
+            var it = self.entries.iterator();
+            var i: usize = 0;
+
+            while (it.next()) |entry| : (i += 1) {
+                reports[i] = HandlerReport.fromStats(entry.key_ptr.*, entry.value_ptr.name, &entry.value_ptr.stats);
+            }
+
+            return reports;
+        }
+
+        /// Clears timing of every handler
+        pub fn resetHandlerStats(self: *Self) void {
+            if (comptime !dispatch_profiler.enabled) return;
+
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            var it = self.entries.valueIterator();
+            while (it.next()) |entry| entry.stats.reset();
+        }
+
+        /// Prints slowest handlers and resets their stats
+        pub fn printHandlerReport(self: *Self, dispatcher_name: []const u8, max_rows: usize) void {
+            if (comptime !dispatch_profiler.enabled) return;
+
+            const allocator = std.heap.c_allocator;
+            const reports = self.getHandlerReports(allocator) catch return;
+            defer allocator.free(reports);
+
+            dispatch_profiler.printReport(dispatcher_name, reports, max_rows);
+            self.resetHandlerStats();
+        }
+        //#endregion
+
         // --------------------------- HELPER FUNCTIONS --------------------------- //
         fn findEntryByHandlerFn(self: *Self, handler: Fn, data: ?TEventData) ?HashMapEntryInfo {
             var it = self.entries.iterator();
@@ -1,14 +1,27 @@
 const std = @import("std");
 
+const caster = @import("../utils/caster.zig");
+
 const types = @import("../utils/types.zig");
 const DeltaTime = types.Deltatime;
 
 const App = @import("../app.zig").App;
+const dispatch_profiler = @import("dispatch_profiler.zig");
+
 const WindowEvents = @import("events/window_events.zig").WindowEvents;
 const RenderEvents = @import("events/render_events.zig").RenderEvents;
 const KeyCode = @import("../input-system/keycode/keycode.zig").KeyCode;
 const WindowSize = @import("../event-system/models/window_size.zig").WindowSize;
 const MousePosition = @import("../event-system/models/mouse_position.zig").MousePosition;
+const EventRecorder = @import("event_recorder.zig").EventRecorder;
+const EventReplayer = @import("event_replayer.zig").EventReplayer;
+const MainThreadQueue = @import("main_thread_queue.zig").MainThreadQueue;
+
+const timer_wheel = @import("timer_wheel.zig");
+const TimerWheel = timer_wheel.TimerWheel;
+const TimerHandle = timer_wheel.TimerHandle;
+const TimerOptions = timer_wheel.TimerOptions;
+const TimerCallbackFn = timer_wheel.TimerCallbackFn;
 
 pub const EventManager = struct {
     arena_allocator: *std.heap.ArenaAllocator,
@@ -16,11 +29,17 @@ pub const EventManager = struct {
     app: *App,
     window_events: *WindowEvents,
     render_events: *RenderEvents,
+    timer_wheel: *TimerWheel,
 
     mutex: std.Thread.Mutex,
     thread: std.Thread,
     event_queue: std.ArrayList(RawEventThreaded),
     event_queue_condition: std.Thread.Condition,
+    main_queue: MainThreadQueue,
+
+    frame_index: u64,
+    recorder: ?*EventRecorder,
+    replayer: ?*EventReplayer,
 
     pub fn create(arena_allocator: *std.heap.ArenaAllocator, app: *App) !EventManager {
         // Allocate events
@@ -35,10 +54,15 @@ pub const EventManager = struct {
             .app = app,
             .window_events = window_events_ptr,
             .render_events = render_events_ptr,
+            .timer_wheel = try TimerWheel.create(),
             .mutex = std.Thread.Mutex{},
             .thread = undefined,
             .event_queue = std.ArrayList(RawEventThreaded){},
             .event_queue_condition = std.Thread.Condition{},
+            .main_queue = MainThreadQueue.init(),
+            .frame_index = 0,
+            .recorder = null,
+            .replayer = null,
         };
     }
 
@@ -52,6 +76,8 @@ pub const EventManager = struct {
     /// # Arguments
     /// * `event`: Event to be dispatched
     pub fn dispatchEventOnEventThread(self: *EventManager, event: RawEventThreaded) void {
+        if (self.recorder) |recorder| recorder.recordRawEvent(event);
+
         self.mutex.lock();
         defer self.mutex.unlock();
 
@@ -63,14 +89,93 @@ pub const EventManager = struct {
         self.event_queue_condition.signal();
     }
 
-    /// Dispatches event on main thread
+    /// Queues event to be dispatched on frame thread during input phase of the next frame.
+    /// Events are collected per thread and handed over when `flushQueuedEvents()` is called,
+    /// so platforms can queue everything they read from the OS and publish it once.
     ///
     /// # Arguments
-    /// * `event`: Event to be dispatched
+    /// * `event`: Event to be dispatched, must not be `Update` or `PostRender`
+    pub fn queueEvent(self: *EventManager, event: RawEvent) void {
+        self.main_queue.push(event);
+    }
+
+    /// Hands events queued by the calling thread over to the frame thread
+    pub fn flushQueuedEvents(self: *EventManager) void {
+        self.main_queue.flush();
+    }
+
+    /// Queues single event for the frame thread and hands it over immediately
+    ///
+    /// # Arguments
+    /// * `event`: Event to be dispatched, must not be `Update` or `PostRender`
     pub fn dispatchEventOnMainThread(self: *EventManager, event: RawEvent) void {
-        self.mainThreadDispatch(event);
+        self.main_queue.push(event);
+        self.main_queue.flush();
     }
 
+    //#region Frame phases
+    /// Runs input and update phases of a frame. Must be called from the frame thread before rendering.
+    ///
+    /// # Arguments
+    /// - `measured_delta`: Time since last frame in seconds
+    ///
+    /// # Returns
+    /// - `DeltaTime`: Delta time reported to update handlers, pass it to `endFrame()`
+    pub fn beginFrame(self: *EventManager, measured_delta: DeltaTime) DeltaTime {
+        const delta = self.advanceFrame(measured_delta);
+
+        self.runInputPhase();
+
+        self.timer_wheel.advance(delta);
+        self.render_events.on_update.dispatch(delta) catch |e| mainThreadEventDispatchFailed(e, .{ .Update = delta });
+
+        return delta;
+    }
+
+    /// Runs post render phase of a frame. Must be called from the frame thread after rendering.
+    pub fn endFrame(self: *EventManager, delta: DeltaTime) void {
+        self.render_events.on_post_render.dispatch(delta) catch |e| mainThreadEventDispatchFailed(e, .{ .PostRender = delta });
+    }
+
+    /// Dispatches input phase event right away, updating input system and recording it.
+    /// Used by input phase and replay, everyone else should use `queueEvent()`.
+    pub fn dispatchInputEvent(self: *EventManager, event: RawEvent) void {
+        if (self.recorder) |recorder| recorder.recordRawEvent(event);
+
+        switch (event) {
+            .KeyDown => |key| {
+                self.app.input_system.registerKey(key);
+                self.window_events.on_key_down.dispatch(key) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .KeyUp => |key| {
+                self.app.input_system.unregisterKey(key);
+                self.window_events.on_key_up.dispatch(key) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .WindowClose => {
+                self.window_events.on_window_close.dispatch(event.WindowClose) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .WindowDestroy => {
+                self.window_events.on_window_destroy.dispatch(event.WindowDestroy) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .WindowResize => {
+                self.window_events.on_window_resize.dispatch(event.WindowResize) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .MouseMove => {
+                self.window_events.on_mouse_move.dispatch(event.MouseMove) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .WindowFocusGain => {
+                self.window_events.on_window_focus_gain.dispatch(event.WindowFocusGain) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .WindowFocusLose => {
+                self.window_events.on_window_focus_lose.dispatch(event.WindowFocusLose) catch |e| mainThreadEventDispatchFailed(e, event);
+            },
+            .Update, .PostRender => {
+                std.log.warn("{s} is driven by beginFrame()/endFrame() and can not be queued", .{@tagName(event)});
+            },
+        }
+    }
+    //#endregion
+
     pub fn getWindowEvents(self: *EventManager) *WindowEvents {
         return self.window_events;
     }
@@ -79,15 +184,173 @@ pub const EventManager = struct {
         return self.render_events;
     }
 
+    //#region Timers
+    /// Schedules callback to run once after `delay` seconds.
+    /// Timers advance with update delta time and run right before update handlers.
+    ///
+    /// # Arguments
+    /// - `delay`: Seconds until callback runs
+    /// - `callback`: Function to call
+    /// - `data`: User data passed to callback
+    pub fn scheduleTimer(self: *EventManager, delay: DeltaTime, callback: TimerCallbackFn, data: ?*anyopaque) !TimerHandle {
+        return try self.timer_wheel.schedule(delay, callback, data, .{});
+    }
+
+    /// Schedules callback to run after `delay` seconds and then every `interval` seconds until cancelled
+    pub fn scheduleRepeatingTimer(self: *EventManager, delay: DeltaTime, interval: DeltaTime, callback: TimerCallbackFn, data: ?*anyopaque) !TimerHandle {
+        return try self.timer_wheel.schedule(delay, callback, data, .{ .repeat_interval = interval });
+    }
+
+    /// Schedules timer with full control over repeat interval and dispatch mode
+    pub fn scheduleTimerWithOptions(self: *EventManager, delay: DeltaTime, callback: TimerCallbackFn, data: ?*anyopaque, options: TimerOptions) !TimerHandle {
+        return try self.timer_wheel.schedule(delay, callback, data, options);
+    }
+
+    /// Cancels timer
+    ///
+    /// # Returns
+    /// - `true` if timer was still pending
+    pub fn cancelTimer(self: *EventManager, handle: TimerHandle) bool {
+        return self.timer_wheel.cancel(handle);
+    }
+
+    /// Whether any timer still waits to run, frames must not be paused until it does
+    pub fn hasPendingTimers(self: *EventManager) bool {
+        return self.timer_wheel.hasScheduled();
+    }
+    //#endregion
+
+    //#region Profiling
+    /// Periodically prints slowest handlers of every dispatcher.
+    /// Does nothing unless built with `-Ddispatch-profiling=true`.
+    ///
+    /// # Arguments
+    /// - `interval`: Seconds between reports
+    /// - `budget_ns`: Handler calls slower than this are flagged in reports
+    pub fn enableDispatchReports(self: *EventManager, interval: DeltaTime, budget_ns: u64) !TimerHandle {
+        if (comptime !dispatch_profiler.enabled) {
+            std.log.warn("Dispatch reports requested but engine was built without -Ddispatch-profiling=true", .{});
+            return TimerHandle.invalid;
+        }
+
+        dispatch_profiler.setBudget(budget_ns);
+        return try self.scheduleRepeatingTimer(interval, interval, printDispatchReports, self);
+    }
+
+    /// Prints slowest handlers of every dispatcher and resets their stats
+    pub fn printDispatchReports(_: TimerHandle, data: ?*anyopaque) anyerror!void {
+        const self = try caster.castFromNullableAnyopaque(EventManager, data);
+        const max_rows = 10;
+
+        self.render_events.on_update.printHandlerReport("on_update", max_rows);
+        self.render_events.on_post_render.printHandlerReport("on_post_render", max_rows);
+        self.window_events.on_key_down.printHandlerReport("on_key_down", max_rows);
+        self.window_events.on_key_up.printHandlerReport("on_key_up", max_rows);
+        self.window_events.on_window_resize.printHandlerReport("on_window_resize", max_rows);
+        self.window_events.on_mouse_move.printHandlerReport("on_mouse_move", max_rows);
+    }
+    //#endregion
+
+    /// Returns number of updates dispatched so far
+    pub fn getFrameIndex(self: *EventManager) u64 {
+        return self.frame_index;
+    }
+
+    //#region Recording
+    /// Starts recording every raw event, input system state is rebuilt from raw key events on replay
+    ///
+    /// # Arguments
+    /// - `path`: File the recording is written to by `stopRecording()`
+    ///
+    /// # Errors
+    /// - `RecordingAlreadyInProgress`: Recorder is already running
+    /// - `ReplayInProgress`: Recording while replaying would record the replay itself
+    pub fn startRecording(self: *EventManager, path: []const u8) !void {
+        if (self.recorder != null) return EventManagerError.RecordingAlreadyInProgress;
+        if (self.replayer != null) return EventManagerError.ReplayInProgress;
+
+        const recorder = try EventRecorder.create(path);
+        self.recorder = recorder;
+    }
+
+    /// Stops recording and writes recording to disk
+    ///
+    /// # Errors
+    /// - `NoRecordingInProgress`: Recorder is not running
+    pub fn stopRecording(self: *EventManager) !void {
+        const recorder = self.recorder orelse return EventManagerError.NoRecordingInProgress;
+
+        self.recorder = null;
+
+        defer recorder.destroy();
+        try recorder.flush();
+    }
+
+    /// Starts replaying recording made with `startRecording()`.
+    /// Each update consumes one recorded frame and reports `fixed_delta` as delta time.
+    ///
+    /// # Arguments
+    /// - `path`: Recording file
+    /// - `fixed_delta`: Delta time of every replayed frame
+    ///
+    /// # Errors
+    /// - `ReplayInProgress`: Replay is already running
+    /// - `RecordingAlreadyInProgress`: Replaying while recording would record the replay itself
+    pub fn startReplay(self: *EventManager, path: []const u8, fixed_delta: DeltaTime) !void {
+        if (self.replayer != null) return EventManagerError.ReplayInProgress;
+        if (self.recorder != null) return EventManagerError.RecordingAlreadyInProgress;
+
+        self.replayer = try EventReplayer.create(path, fixed_delta);
+    }
+
+    pub fn isReplaying(self: *EventManager) bool {
+        return self.replayer != null;
+    }
+
+    /// Flushes anything that must survive the process exiting. Called by platforms right before they exit.
+    pub fn shutdown(self: *EventManager) void {
+        if (self.recorder != null) {
+            self.stopRecording() catch |e| std.log.err("Failed to write recording: {}", .{e});
+        }
+    }
+    //#endregion
+
     // --------------------------- HLPER FUNCTIONS --------------------------- //
-    fn mainThreadDispatch(self: *EventManager, event: RawEvent) void {
-        switch (event) {
-            .Update => {
-                self.render_events.on_update.dispatch(event.Update) catch |e| mainThreadEventDispatchFailed(e, event);
-            },
-            .PostRender => {
-                self.render_events.on_post_render.dispatch(event.PostRender) catch |e| mainThreadEventDispatchFailed(e, event);
-            },
+    /// Advances frame counter, recorder and replayer
+    ///
+    /// # Returns
+    /// - `DeltaTime`: Delta time that should be reported to update handlers
+    fn advanceFrame(self: *EventManager, measured_delta: DeltaTime) DeltaTime {
+        self.frame_index += 1;
+
+        if (self.recorder) |recorder| recorder.advanceFrame();
+
+        var delta = measured_delta;
+        if (self.replayer) |replayer| {
+            delta = replayer.getFixedDelta();
+            replayer.feedFrame(self);
+
+            if (replayer.isFinished()) {
+                std.log.info("Replay finished after {} frames", .{replayer.frame_index});
+                self.replayer = null;
+                replayer.destroy();
+            }
+        }
+
+        return delta;
+    }
+
+    /// Dispatches every event handed over since the previous frame, in the order it was queued
+    fn runInputPhase(self: *EventManager) void {
+        const batches = self.main_queue.takeAll();
+        defer MainThreadQueue.freeBatches(batches);
+
+        // Live input is dropped while replaying, recorded events already stood in for it
+        if (self.replayer != null) return;
+
+        var batch = batches;
+        while (batch) |current| : (batch = current.next) {
+            for (current.getEvents()) |event| self.dispatchInputEvent(event);
         }
     }
 
@@ -154,7 +417,23 @@ pub const EventManager = struct {
     }
 };
 
-pub const RawEventThreaded = union(enum) {
+/// Phases every frame goes through, in this order, on the frame thread
+pub const FramePhase = enum {
+    /// Events queued since the previous frame are dispatched and input system is updated
+    Input,
+    /// Timers fire, then update handlers run
+    Update,
+    /// Platform renders the frame, no events are dispatched
+    Render,
+    /// Post render handlers run
+    PostRender,
+};
+
+/// Events coming from the platform.
+/// When queued with `queueEvent()` or `dispatchEventOnMainThread()` every kind runs in the phase returned by `phase()`,
+/// so handlers never run concurrently with update handlers or rendering and do not need to lock scene state.
+/// Events sent with `dispatchEventOnEventThread()` run on the event thread whenever it picks them up and give no such guarantee.
+pub const RawEvent = union(enum) {
     KeyDown: KeyCode,
     KeyUp: KeyCode,
     WindowClose: void,
@@ -165,9 +444,21 @@ pub const RawEventThreaded = union(enum) {
     WindowFocusLose: void,
     Update: DeltaTime,
     PostRender: DeltaTime,
+
+    pub fn phase(self: RawEvent) FramePhase {
+        return switch (self) {
+            .KeyDown, .KeyUp, .WindowClose, .WindowDestroy, .WindowResize, .MouseMove, .WindowFocusGain, .WindowFocusLose => .Input,
+            .Update => .Update,
+            .PostRender => .PostRender,
+        };
+    }
 };
 
-pub const RawEvent = union(enum) {
-    Update: DeltaTime,
-    PostRender: DeltaTime,
+/// Event thread accepts the same events as the frame thread
+pub const RawEventThreaded = RawEvent;
+
+pub const EventManagerError = error{
+    RecordingAlreadyInProgress,
+    NoRecordingInProgress,
+    ReplayInProgress,
 };
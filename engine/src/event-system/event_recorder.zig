@@ -0,0 +1,104 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const recorded_event = @import("models/recorded_event.zig");
+const RecordedEntry = recorded_event.RecordedEntry;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+const RawEventThreaded = @import("event_manager.zig").RawEventThreaded;
+
+/// Writes every raw event into a compact binary log.
+/// Input system is not recorded separately, it follows the raw key events when they are replayed.
+/// Records are kept in memory and written to disk on `flush()` so recording never touches the disk mid-frame.
+pub const EventRecorder = struct {
+    allocator: Allocator,
+    mutex: std.Thread.Mutex,
+
+    path: []const u8,
+    buffer: ArrayList(u8),
+
+    start_timestamp: i128,
+    frame_index: u64,
+    previous_entry: ?RecordedEntry,
+    entry_count: usize,
+
+    /// Creates recorder that will write into file at `path`
+    pub fn create(path: []const u8) !*EventRecorder {
+        const allocator = std.heap.c_allocator;
+
+        var buffer = try ArrayList(u8).initCapacity(allocator, 64 * 1024);
+        errdefer buffer.deinit(allocator);
+        try recorded_event.writeHeader(&buffer, allocator);
+
+        const owned_path = try allocator.dupe(u8, path);
+        errdefer allocator.free(owned_path);
+
+        const recorder = try cAlloc(EventRecorder);
+        recorder.* = EventRecorder{
+            .allocator = allocator,
+            .mutex = std.Thread.Mutex{},
+            .path = owned_path,
+            .buffer = buffer,
+            .start_timestamp = std.time.nanoTimestamp(),
+            .frame_index = 0,
+            .previous_entry = null,
+            .entry_count = 0,
+        };
+
+        return recorder;
+    }
+
+    pub fn destroy(self: *EventRecorder) void {
+        self.buffer.deinit(self.allocator);
+        self.allocator.free(self.path);
+        cFree(self);
+    }
+
+    /// Marks the start of the next frame. Called by event manager once per update.
+    pub fn advanceFrame(self: *EventRecorder) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.frame_index += 1;
+    }
+
+    pub fn recordRawEvent(self: *EventRecorder, event: RawEventThreaded) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const elapsed_ns = std.time.nanoTimestamp() - self.start_timestamp;
+        const entry = RecordedEntry{
+            .frame_index = self.frame_index,
+            .timestamp_us = @intCast(@divTrunc(@max(elapsed_ns, 0), std.time.ns_per_us)),
+            .event = event,
+        };
+
+        recorded_event.encodeEntry(&self.buffer, self.allocator, entry, self.previous_entry) catch |e| {
+            std.log.err("Failed to record event: {}", .{e});
+            return;
+        };
+
+        self.previous_entry = entry;
+        self.entry_count += 1;
+    }
+
+    /// Writes everything recorded so far into the output file
+    pub fn flush(self: *EventRecorder) !void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const file = try std.fs.cwd().createFile(self.path, .{});
+        defer file.close();
+
+        try file.writeAll(self.buffer.items);
+    }
+
+    pub fn getEntryCount(self: *EventRecorder) usize {
+        return self.entry_count;
+    }
+};
@@ -0,0 +1,103 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const types = @import("../utils/types.zig");
+const DeltaTime = types.Deltatime;
+
+const recorded_event = @import("models/recorded_event.zig");
+const RecordedEntry = recorded_event.RecordedEntry;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+const EventManager = @import("event_manager.zig").EventManager;
+
+/// Largest recording that will be loaded into memory
+const max_recording_size: usize = 256 * 1024 * 1024;
+
+/// Feeds a recording made by `EventRecorder` back through event manager, which updates input system from the key events.
+/// Every update advances the replay by exactly one recorded frame and reports `fixed_delta`
+/// instead of the measured frame time, so replay does not depend on how fast the machine runs.
+pub const EventReplayer = struct {
+    allocator: Allocator,
+
+    entries: ArrayList(RecordedEntry),
+    cursor: usize,
+
+    frame_index: u64,
+    fixed_delta: DeltaTime,
+
+    /// Loads recording from `path`
+    ///
+    /// # Arguments
+    /// - `path`: Recording file written by `EventRecorder`
+    /// - `fixed_delta`: Delta time reported to update handlers for every replayed frame
+    ///
+    /// # Errors
+    /// - `InvalidRecording`: File is not a recording
+    /// - `UnsupportedRecordingVersion`: Recording was written by incompatible version
+    /// - `UnexpectedEndOfRecording`: Recording is truncated
+    pub fn create(path: []const u8, fixed_delta: DeltaTime) !*EventReplayer {
+        const allocator = std.heap.c_allocator;
+
+        const bytes = try std.fs.cwd().readFileAlloc(allocator, path, max_recording_size);
+        defer allocator.free(bytes);
+
+        var entries = ArrayList(RecordedEntry){};
+        errdefer entries.deinit(allocator);
+
+        var reader = try recorded_event.readHeader(bytes);
+        while (!reader.isAtEnd()) {
+            try entries.append(allocator, try reader.next());
+        }
+
+        const replayer = try cAlloc(EventReplayer);
+        replayer.* = EventReplayer{
+            .allocator = allocator,
+            .entries = entries,
+            .cursor = 0,
+            .frame_index = 0,
+            .fixed_delta = fixed_delta,
+        };
+
+        return replayer;
+    }
+
+    pub fn destroy(self: *EventReplayer) void {
+        self.entries.deinit(self.allocator);
+        cFree(self);
+    }
+
+    /// Replays all entries recorded up to and including the current frame, then advances to the next frame.
+    /// Raw events are dispatched right away as part of the input phase.
+    /// Update and post render entries are skipped since replay drives frames itself.
+    ///
+    /// # Arguments
+    /// - `event_manager`: Receives raw events
+    pub fn feedFrame(self: *EventReplayer, event_manager: *EventManager) void {
+        while (self.cursor < self.entries.items.len) {
+            const entry = self.entries.items[self.cursor];
+            if (entry.frame_index > self.frame_index) break;
+
+            switch (entry.event) {
+                .Update, .PostRender => {},
+                else => event_manager.dispatchInputEvent(entry.event),
+            }
+
+            self.cursor += 1;
+        }
+
+        self.frame_index += 1;
+    }
+
+    pub fn isFinished(self: *EventReplayer) bool {
+        return self.cursor >= self.entries.items.len;
+    }
+
+    pub fn getFixedDelta(self: *EventReplayer) DeltaTime {
+        return self.fixed_delta;
+    }
+};
@@ -33,6 +33,16 @@ pub const RenderEvents = struct {
         return try self.on_post_render.addHandler(fun, data);
     }
 
+    /// Same as `registerOnUpdate()` but `name` identifies handler in profiler reports
+    pub fn registerNamedOnUpdate(self: *RenderEvents, fun: UpdateDispatcherFn, data: ?*anyopaque, name: []const u8) !EntryId {
+        return try self.on_update.addNamedHandler(fun, data, name);
+    }
+
+    /// Same as `registerOnPostRender()` but `name` identifies handler in profiler reports
+    pub fn registerNamedOnPostRender(self: *RenderEvents, fun: UpdateDispatcherFn, data: ?*anyopaque, name: []const u8) !EntryId {
+        return try self.on_post_render.addNamedHandler(fun, data, name);
+    }
+
     // --------------------------- UNREGISTER --------------------------- //
     pub fn unregisterOnUpdate(self: *RenderEvents, fun: UpdateDispatcherFn, data: ?*anyopaque) !void {
         try self.on_update.removeHandler(fun, data);
@@ -5,6 +5,8 @@ const WindowSize = @import("../models/window_size.zig").WindowSize;
 const KeyCode = @import("../../input-system/keycode/keycode.zig").KeyCode;
 const MousePosition = @import("../models/mouse_position.zig").MousePosition;
 const EventDispatcher = @import("../event_dispatcher.zig").EventDispatcher;
+const KeyEventDispatcher = @import("../key_event_dispatcher.zig").KeyEventDispatcher;
+const KeyCombo = @import("../key_event_dispatcher.zig").KeyCombo;
 
 const EmptyDispatcherFn = *const fn (void, ?*anyopaque) anyerror!void;
 const KeyPressedDispetcherFn = *const fn (KeyCode, ?*anyopaque) anyerror!void;
@@ -12,8 +14,8 @@ const WindowResizeDispatcherFn = *const fn (WindowSize, ?*anyopaque) anyerror!vo
 const MouseMoveDispatcherFn = *const fn (MousePosition, ?*anyopaque) anyerror!void;
 
 pub const WindowEvents = struct {
-    on_key_down: *EventDispatcher(KeyCode, *anyopaque),
-    on_key_up: *EventDispatcher(KeyCode, *anyopaque),
+    on_key_down: *KeyEventDispatcher,
+    on_key_up: *KeyEventDispatcher,
     on_window_close: *EventDispatcher(void, *anyopaque),
     on_window_destroy: *EventDispatcher(void, *anyopaque),
     on_window_resize: *EventDispatcher(WindowSize, *anyopaque),
@@ -23,8 +25,8 @@ pub const WindowEvents = struct {
 
     pub fn init() !WindowEvents {
         return WindowEvents{
-            .on_key_down = try EventDispatcher(KeyCode, *anyopaque).create(),
-            .on_key_up = try EventDispatcher(KeyCode, *anyopaque).create(),
+            .on_key_down = try KeyEventDispatcher.create(),
+            .on_key_up = try KeyEventDispatcher.create(),
             .on_window_close = try EventDispatcher(void, *anyopaque).create(),
             .on_window_destroy = try EventDispatcher(void, *anyopaque).create(),
             .on_window_resize = try EventDispatcher(WindowSize, *anyopaque).create(),
@@ -43,6 +45,21 @@ pub const WindowEvents = struct {
         return try self.on_key_up.addHandler(fun, data);
     }
 
+    /// Registers key down handler that only runs for `key`
+    pub fn registerOnKeyDownFor(self: *WindowEvents, key: KeyCode, fun: KeyPressedDispetcherFn, data: ?*anyopaque) !EntryId {
+        return try self.on_key_down.addKeyHandler(key, fun, data);
+    }
+
+    /// Registers key up handler that only runs for `key`
+    pub fn registerOnKeyUpFor(self: *WindowEvents, key: KeyCode, fun: KeyPressedDispetcherFn, data: ?*anyopaque) !EntryId {
+        return try self.on_key_up.addKeyHandler(key, fun, data);
+    }
+
+    /// Registers key down handler that only runs for `combo.key` while combo modifiers are held
+    pub fn registerOnKeyComboDown(self: *WindowEvents, combo: KeyCombo, fun: KeyPressedDispetcherFn, data: ?*anyopaque) !EntryId {
+        return try self.on_key_down.addComboHandler(combo, fun, data);
+    }
+
     pub fn registerOnWindowClose(self: *WindowEvents, fun: EmptyDispatcherFn, data: ?*anyopaque) !EntryId {
         return try self.on_window_close.addHandler(fun, data);
     }
@@ -76,6 +93,14 @@ pub const WindowEvents = struct {
         try self.on_key_up.removeHandler(fun, data);
     }
 
+    pub fn unregisterOnKeyDownFor(self: *WindowEvents, key: KeyCode, fun: KeyPressedDispetcherFn, data: ?*anyopaque) void {
+        self.on_key_down.removeKeyHandler(key, fun, data);
+    }
+
+    pub fn unregisterOnKeyUpFor(self: *WindowEvents, key: KeyCode, fun: KeyPressedDispetcherFn, data: ?*anyopaque) void {
+        self.on_key_up.removeKeyHandler(key, fun, data);
+    }
+
     pub fn unregisterOnWindowClose(self: *WindowEvents, fun: EmptyDispatcherFn, data: ?*anyopaque) !void {
         try self.on_window_close.removeHandler(fun, data);
     }
@@ -0,0 +1,290 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+const App = @import("../app.zig").App;
+const KeyCode = @import("../input-system/keycode/keycode.zig").KeyCode;
+const EventDispatcher = @import("event_dispatcher.zig").EventDispatcher;
+const EntryKey = @import("event_dispatcher.zig").EntryKey;
+
+const dispatch_profiler = @import("dispatch_profiler.zig");
+const HandlerReport = dispatch_profiler.HandlerReport;
+const ProfilerStats = if (dispatch_profiler.enabled) dispatch_profiler.HandlerStats else void;
+
+const key_count = @typeInfo(KeyCode).@"enum".fields.len;
+const max_modifiers = 4;
+
+const KeyHandlerFn = *const fn (KeyCode, ?*anyopaque) anyerror!void;
+
+/// Key together with modifier keys that have to be held for the combo to fire, e.g. Ctrl + S
+pub const KeyCombo = struct {
+    key: KeyCode,
+    modifiers: [max_modifiers]KeyCode = .{.Unknown} ** max_modifiers,
+    modifier_count: u8 = 0,
+
+    pub fn init(key: KeyCode, modifiers: []const KeyCode) KeyCombo {
+        std.debug.assert(modifiers.len <= max_modifiers);
+
+        var combo = KeyCombo{ .key = key };
+        for (modifiers, 0..) |modifier, i| combo.modifiers[i] = modifier;
+        combo.modifier_count = @intCast(modifiers.len);
+
+        return combo;
+    }
+
+    pub fn getModifiers(self: *const KeyCombo) []const KeyCode {
+        return self.modifiers[0..self.modifier_count];
+    }
+};
+
+const KeyHandlerEntry = struct {
+    id: EntryKey,
+    callback: KeyHandlerFn,
+    data: ?*anyopaque,
+    combo: KeyCombo,
+    is_paused: bool,
+
+    stats: ProfilerStats,
+};
+
+/// Key event dispatcher with a handler table per key code.
+/// Filtered handlers only run for the key (or combo) they subscribed to, unfiltered handlers run for every key.
+/// Filtered ids are negative and unfiltered ones are not, so ids of both kinds never collide and every `*ById()`
+/// function accepts either.
+pub const KeyEventDispatcher = struct {
+    allocator: Allocator,
+    mutex: std.Thread.Mutex,
+
+    unfiltered: *EventDispatcher(KeyCode, *anyopaque),
+    per_key: [key_count]ArrayList(KeyHandlerEntry),
+    id_to_key: std.AutoHashMap(EntryKey, KeyCode), // Lets removal by id touch only a single key table
+
+    next_filtered_id: EntryKey = -1, // Counts down, unfiltered dispatcher counts up from 0
+
+    pub fn create() !*KeyEventDispatcher {
+        const allocator = std.heap.c_allocator;
+
+        const ptr = try cAlloc(KeyEventDispatcher);
+        ptr.* = KeyEventDispatcher{
+            .allocator = allocator,
+            .mutex = std.Thread.Mutex{},
+            .unfiltered = try EventDispatcher(KeyCode, *anyopaque).create(),
+            .per_key = [_]ArrayList(KeyHandlerEntry){ArrayList(KeyHandlerEntry){}} ** key_count,
+            .id_to_key = std.AutoHashMap(EntryKey, KeyCode).init(allocator),
+        };
+
+        return ptr;
+    }
+
+    pub fn destroy(self: *KeyEventDispatcher) void {
+        for (&self.per_key) |*handlers| handlers.deinit(self.allocator);
+        self.id_to_key.deinit();
+        self.unfiltered.destroy();
+        cFree(self);
+    }
+
+    //#region Unfiltered handlers
+    /// Adds handler that is called for every key
+    pub fn addHandler(self: *KeyEventDispatcher, handler: KeyHandlerFn, data: ?*anyopaque) !EntryKey {
+        return try self.unfiltered.addHandler(handler, data);
+    }
+
+    pub fn removeHandler(self: *KeyEventDispatcher, handler: KeyHandlerFn, data: ?*anyopaque) !void {
+        try self.unfiltered.removeHandler(handler, data);
+    }
+
+    pub fn removeHandlerById(self: *KeyEventDispatcher, id: EntryKey) !void {
+        if (isFilteredId(id)) return self.removeKeyHandlerById(id);
+        try self.unfiltered.removeHandlerById(id);
+    }
+
+    pub fn pauseHandlerById(self: *KeyEventDispatcher, id: EntryKey) !void {
+        if (isFilteredId(id)) return self.pauseKeyHandlerById(id);
+        try self.unfiltered.pauseHandlerById(id);
+    }
+
+    pub fn resumeHandlerById(self: *KeyEventDispatcher, id: EntryKey) !void {
+        if (isFilteredId(id)) return self.resumeKeyHandlerById(id);
+        try self.unfiltered.resumeHandlerById(id);
+    }
+    //#endregion
+
+    //#region Filtered handlers
+    /// Adds handler that is called only for `key`
+    ///
+    /// # Returns
+    /// - `EntryKey`: Id of the filtered handler, use with `*KeyHandlerById()` functions
+    pub fn addKeyHandler(self: *KeyEventDispatcher, key: KeyCode, handler: KeyHandlerFn, data: ?*anyopaque) !EntryKey {
+        return try self.addComboHandler(KeyCombo{ .key = key }, handler, data);
+    }
+
+    /// Adds handler that is called only for `combo.key` while all combo modifiers are held
+    ///
+    /// # Returns
+    /// - `EntryKey`: Id of the filtered handler, use with `*KeyHandlerById()` functions
+    pub fn addComboHandler(self: *KeyEventDispatcher, combo: KeyCombo, handler: KeyHandlerFn, data: ?*anyopaque) !EntryKey {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const id = self.next_filtered_id;
+
+        try self.id_to_key.put(id, combo.key);
+        errdefer _ = self.id_to_key.remove(id);
+
+        try self.per_key[@intFromEnum(combo.key)].append(self.allocator, KeyHandlerEntry{
+            .id = id,
+            .callback = handler,
+            .data = data,
+            .combo = combo,
+            .is_paused = false,
+            .stats = if (dispatch_profiler.enabled) dispatch_profiler.HandlerStats{} else {},
+        });
+
+        self.next_filtered_id -= 1;
+        return id;
+    }
+
+    /// Removes filtered handler by handler function
+    pub fn removeKeyHandler(self: *KeyEventDispatcher, key: KeyCode, handler: KeyHandlerFn, data: ?*anyopaque) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const handlers = &self.per_key[@intFromEnum(key)];
+        for (handlers.items, 0..) |entry, i| {
+            if (entry.callback == handler and entry.data == data) {
+                _ = self.id_to_key.remove(entry.id);
+                _ = handlers.orderedRemove(i);
+                return;
+            }
+        }
+    }
+
+    /// Removes filtered handler by id
+    pub fn removeKeyHandlerById(self: *KeyEventDispatcher, id: EntryKey) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const key = self.id_to_key.get(id) orelse return;
+        _ = self.id_to_key.remove(id);
+
+        const handlers = &self.per_key[@intFromEnum(key)];
+        if (findEntryIndex(handlers, id)) |i| _ = handlers.orderedRemove(i);
+    }
+
+    pub fn pauseKeyHandlerById(self: *KeyEventDispatcher, id: EntryKey) void {
+        self.setKeyHandlerPaused(id, true);
+    }
+
+    pub fn resumeKeyHandlerById(self: *KeyEventDispatcher, id: EntryKey) void {
+        self.setKeyHandlerPaused(id, false);
+    }
+    //#endregion
+
+    /// Calls handlers subscribed to `key` followed by unfiltered handlers
+    pub fn dispatch(self: *KeyEventDispatcher, key: KeyCode) anyerror!void {
+        {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            const handlers = self.per_key[@intFromEnum(key)].items;
+            if (handlers.len > 0) {
+                const input = App.get().input_system;
+
+                for (handlers) |*entry| {
+                    if (entry.is_paused) continue;
+                    if (entry.combo.modifier_count > 0 and !input.isComboPressed(entry.combo.getModifiers())) continue;
+
+                    if (comptime dispatch_profiler.enabled) {
+                        const start = dispatch_profiler.startTiming();
+                        defer entry.stats.record(dispatch_profiler.elapsedSince(start));
+
+                        try entry.callback(key, entry.data);
+                    } else {
+                        try entry.callback(key, entry.data);
+                    }
+                }
+            }
+        }
+
+        try self.unfiltered.dispatch(key);
+    }
+
+    //#region Profiling
+    /// Returns timing of every filtered and unfiltered handler, empty unless built with `-Ddispatch-profiling=true`.
+    /// Filtered handlers are named after the key they subscribed to. Caller owns returned slice.
+    pub fn getHandlerReports(self: *KeyEventDispatcher, allocator: Allocator) ![]HandlerReport {
+        if (comptime !dispatch_profiler.enabled) return &.{};
+
+        const unfiltered = try self.unfiltered.getHandlerReports(allocator);
+        defer allocator.free(unfiltered);
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        var reports = ArrayList(HandlerReport){};
+        errdefer reports.deinit(allocator);
+
+        try reports.appendSlice(allocator, unfiltered);
+        for (&self.per_key) |*handlers| {
+            for (handlers.items) |*entry| {
+                try reports.append(allocator, HandlerReport.fromStats(entry.id, @tagName(entry.combo.key), &entry.stats));
+            }
+        }
+
+        return reports.toOwnedSlice(allocator);
+    }
+
+    /// Clears timing of every handler
+    pub fn resetHandlerStats(self: *KeyEventDispatcher) void {
+        if (comptime !dispatch_profiler.enabled) return;
+
+        self.unfiltered.resetHandlerStats();
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        for (&self.per_key) |*handlers| {
+            for (handlers.items) |*entry| entry.stats.reset();
+        }
+    }
+
+    /// Prints slowest filtered and unfiltered handlers together and resets their stats
+    pub fn printHandlerReport(self: *KeyEventDispatcher, dispatcher_name: []const u8, max_rows: usize) void {
+        if (comptime !dispatch_profiler.enabled) return;
+
+        const allocator = std.heap.c_allocator;
+        const reports = self.getHandlerReports(allocator) catch return;
+        defer allocator.free(reports);
+
+        dispatch_profiler.printReport(dispatcher_name, reports, max_rows);
+        self.resetHandlerStats();
+    }
+    //#endregion
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn isFilteredId(id: EntryKey) bool {
+        return id < 0;
+    }
+
+    fn setKeyHandlerPaused(self: *KeyEventDispatcher, id: EntryKey, is_paused: bool) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const key = self.id_to_key.get(id) orelse return;
+        const handlers = &self.per_key[@intFromEnum(key)];
+        if (findEntryIndex(handlers, id)) |i| handlers.items[i].is_paused = is_paused;
+    }
+
+    fn findEntryIndex(handlers: *ArrayList(KeyHandlerEntry), id: EntryKey) ?usize {
+        for (handlers.items, 0..) |entry, i| {
+            if (entry.id == id) return i;
+        }
+
+        return null;
+    }
+};
@@ -0,0 +1,104 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const RawEvent = @import("event_manager.zig").RawEvent;
+
+/// Number of events a producer collects before handing them over
+const batch_capacity = 64;
+
+/// Events collected by a single producer thread
+pub const EventBatch = struct {
+    events: [batch_capacity]RawEvent = undefined,
+    len: usize = 0,
+    next: ?*EventBatch = null,
+
+    pub fn isFull(self: *const EventBatch) bool {
+        return self.len == batch_capacity;
+    }
+
+    pub fn getEvents(self: *const EventBatch) []const RawEvent {
+        return self.events[0..self.len];
+    }
+};
+
+// Batch that the calling thread is currently filling. Every producer fills its own batch
+// so queueing an event never touches memory shared with other threads.
+threadlocal var pending_batch: ?*EventBatch = null;
+
+/// Multi producer, single consumer queue of events that are dispatched on the frame thread.
+/// Producers fill a thread local batch and publish it with a single CAS, the frame thread takes
+/// every published batch with a single swap. Neither side ever blocks the other.
+pub const MainThreadQueue = struct {
+    head: std.atomic.Value(?*EventBatch), // Most recently published batch, batches are linked newest to oldest
+
+    pub fn init() MainThreadQueue {
+        return MainThreadQueue{
+            .head = std.atomic.Value(?*EventBatch).init(null),
+        };
+    }
+
+    /// Frees every batch that was published but never taken
+    pub fn deinit(self: *MainThreadQueue) void {
+        freeBatches(self.takeAll());
+    }
+
+    /// Adds event to batch of the calling thread. Batch is published once it is full or on `flush()`.
+    pub fn push(self: *MainThreadQueue, event: RawEvent) void {
+        const batch = pending_batch orelse blk: {
+            const new_batch = cAlloc(EventBatch) catch |e| {
+                std.log.err("Failed to allocate event batch: {}", .{e});
+                return;
+            };
+
+            new_batch.* = EventBatch{};
+            pending_batch = new_batch;
+            break :blk new_batch;
+        };
+
+        batch.events[batch.len] = event;
+        batch.len += 1;
+
+        if (batch.isFull()) self.flush();
+    }
+
+    /// Publishes batch of the calling thread so it is picked up at the start of the next frame
+    pub fn flush(self: *MainThreadQueue) void {
+        const batch = pending_batch orelse return;
+        pending_batch = null;
+
+        var head = self.head.load(.monotonic);
+        while (true) {
+            batch.next = head;
+            head = self.head.cmpxchgWeak(head, batch, .release, .monotonic) orelse return;
+        }
+    }
+
+    /// Takes every published batch
+    ///
+    /// # Returns
+    /// - `?*EventBatch`: Oldest batch, linked to newer ones through `next`. Caller owns batches and frees them with `freeBatches()`.
+    pub fn takeAll(self: *MainThreadQueue) ?*EventBatch {
+        var batch = self.head.swap(null, .acquire);
+
+        // Batches are pushed on top of each other, reverse them so events come out in publish order
+        var oldest: ?*EventBatch = null;
+        while (batch) |current| {
+            batch = current.next;
+            current.next = oldest;
+            oldest = current;
+        }
+
+        return oldest;
+    }
+
+    pub fn freeBatches(first: ?*EventBatch) void {
+        var batch = first;
+        while (batch) |current| {
+            batch = current.next;
+            cFree(current);
+        }
+    }
+};
@@ -0,0 +1,225 @@
+const std = @import("std");
+
+const types = @import("../../utils/types.zig");
+const DeltaTime = types.Deltatime;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+const KeyCode = @import("../../input-system/keycode/keycode.zig").KeyCode;
+const RawEventThreaded = @import("../event_manager.zig").RawEventThreaded;
+const WindowSize = @import("window_size.zig").WindowSize;
+const MousePosition = @import("mouse_position.zig").MousePosition;
+const windowStateFromCInt = @import("window_state.zig").windowStateFromCInt;
+
+/// First bytes of every recording file
+pub const recording_magic = [4]u8{ 'G', 'L', 'Z', 'R' };
+pub const recording_version: u16 = 2; // 1 also stored input system key transitions
+pub const recording_header_size: usize = recording_magic.len + @sizeOf(u16);
+
+pub const RecordedEntry = struct {
+    frame_index: u64, // Frame relative to the start of the recording
+    timestamp_us: u64, // Microseconds relative to the start of the recording
+    event: RawEventThreaded,
+};
+
+/// On-disk tag of a record. Values must never be reordered, only appended.
+const RecordKind = enum(u8) {
+    KeyDown = 0,
+    KeyUp = 1,
+    WindowClose = 2,
+    WindowDestroy = 3,
+    WindowResize = 4,
+    MouseMove = 5,
+    WindowFocusGain = 6,
+    WindowFocusLose = 7,
+    Update = 8,
+    PostRender = 9,
+};
+
+/// Appends recording header to `list`
+pub fn writeHeader(list: *ArrayList(u8), allocator: Allocator) !void {
+    try list.appendSlice(allocator, &recording_magic);
+    try appendInt(u16, list, allocator, recording_version);
+}
+
+/// Validates recording header and returns reader positioned at the first record
+///
+/// # Errors
+/// - `InvalidRecording`: Bytes do not start with a valid recording header
+pub fn readHeader(bytes: []const u8) RecordingError!RecordReader {
+    if (bytes.len < recording_header_size) return RecordingError.InvalidRecording;
+    if (!std.mem.eql(u8, bytes[0..recording_magic.len], &recording_magic)) return RecordingError.InvalidRecording;
+
+    var reader = RecordReader{ .bytes = bytes, .cursor = recording_magic.len };
+    if (try reader.readInt(u16) != recording_version) return RecordingError.UnsupportedRecordingVersion;
+
+    return reader;
+}
+
+/// Encodes single entry. Frame index and timestamp are stored as deltas to the previous entry
+/// which keeps the common case (many events in the same frame) down to a few bytes per record.
+///
+/// # Arguments
+/// - `list`: Output buffer
+/// - `allocator`: Allocator used by `list`
+/// - `entry`: Entry to encode
+/// - `previous`: Previously encoded entry, or null for the first one
+pub fn encodeEntry(list: *ArrayList(u8), allocator: Allocator, entry: RecordedEntry, previous: ?RecordedEntry) !void {
+    const previous_frame = if (previous) |p| p.frame_index else 0;
+    const previous_time = if (previous) |p| p.timestamp_us else 0;
+
+    try list.append(allocator, @intFromEnum(kindOf(entry.event)));
+    try appendVarInt(list, allocator, entry.frame_index - previous_frame);
+    try appendVarInt(list, allocator, entry.timestamp_us -| previous_time);
+
+    switch (entry.event) {
+        .KeyDown, .KeyUp => |key| try appendInt(u16, list, allocator, @intFromEnum(key)),
+        .WindowResize => |size| {
+            try appendInt(u32, list, allocator, size.width);
+            try appendInt(u32, list, allocator, size.height);
+            try list.append(allocator, @intCast(@intFromEnum(size.window_state)));
+        },
+        .MouseMove => |position| {
+            try appendInt(i32, list, allocator, position.x);
+            try appendInt(i32, list, allocator, position.y);
+        },
+        .Update, .PostRender => |delta| try appendInt(u32, list, allocator, @bitCast(delta)),
+        .WindowClose, .WindowDestroy, .WindowFocusGain, .WindowFocusLose => {},
+    }
+}
+
+pub const RecordReader = struct {
+    bytes: []const u8,
+    cursor: usize,
+
+    previous: ?RecordedEntry = null,
+
+    pub fn isAtEnd(self: *const RecordReader) bool {
+        return self.cursor >= self.bytes.len;
+    }
+
+    /// Decodes next entry
+    ///
+    /// # Errors
+    /// - `UnexpectedEndOfRecording`: Record is truncated
+    /// - `InvalidRecording`: Unknown record kind or key code
+    pub fn next(self: *RecordReader) RecordingError!RecordedEntry {
+        const kind_int = try self.readByte();
+        if (kind_int > @intFromEnum(RecordKind.PostRender)) return RecordingError.InvalidRecording;
+        const kind: RecordKind = @enumFromInt(kind_int);
+
+        const previous_frame = if (self.previous) |p| p.frame_index else 0;
+        const previous_time = if (self.previous) |p| p.timestamp_us else 0;
+
+        const frame_index = previous_frame + try self.readVarInt();
+        const timestamp_us = previous_time + try self.readVarInt();
+
+        const event: RawEventThreaded = switch (kind) {
+            .KeyDown => .{ .KeyDown = try self.readKeyCode() },
+            .KeyUp => .{ .KeyUp = try self.readKeyCode() },
+            .WindowClose => .{ .WindowClose = {} },
+            .WindowDestroy => .{ .WindowDestroy = {} },
+            .WindowFocusGain => .{ .WindowFocusGain = {} },
+            .WindowFocusLose => .{ .WindowFocusLose = {} },
+            .WindowResize => r: {
+                const width = try self.readInt(u32);
+                const height = try self.readInt(u32);
+                const state = try self.readByte();
+                break :r .{ .WindowResize = WindowSize.init(width, height, windowStateFromCInt(state)) };
+            },
+            .MouseMove => r: {
+                const x = try self.readInt(i32);
+                const y = try self.readInt(i32);
+                break :r .{ .MouseMove = MousePosition.init(x, y) };
+            },
+            .Update => .{ .Update = @bitCast(try self.readInt(u32)) },
+            .PostRender => .{ .PostRender = @bitCast(try self.readInt(u32)) },
+        };
+
+        const entry = RecordedEntry{
+            .frame_index = frame_index,
+            .timestamp_us = timestamp_us,
+            .event = event,
+        };
+
+        self.previous = entry;
+        return entry;
+    }
+
+    fn readByte(self: *RecordReader) RecordingError!u8 {
+        if (self.cursor >= self.bytes.len) return RecordingError.UnexpectedEndOfRecording;
+
+        const byte = self.bytes[self.cursor];
+        self.cursor += 1;
+        return byte;
+    }
+
+    fn readInt(self: *RecordReader, comptime T: type) RecordingError!T {
+        if (self.cursor + @sizeOf(T) > self.bytes.len) return RecordingError.UnexpectedEndOfRecording;
+
+        const value = std.mem.readInt(T, self.bytes[self.cursor..][0..@sizeOf(T)], .little);
+        self.cursor += @sizeOf(T);
+        return value;
+    }
+
+    fn readVarInt(self: *RecordReader) RecordingError!u64 {
+        var value: u64 = 0;
+        var shift: u6 = 0;
+
+        while (true) {
+            const byte = try self.readByte();
+            value |= @as(u64, byte & 0x7F) << shift;
+
+            if (byte & 0x80 == 0) return value;
+            if (shift >= 63) return RecordingError.InvalidRecording;
+            shift += 7;
+        }
+    }
+
+    fn readKeyCode(self: *RecordReader) RecordingError!KeyCode {
+        const value = try self.readInt(u16);
+        if (value > @intFromEnum(KeyCode.F12)) return RecordingError.InvalidRecording;
+
+        return @enumFromInt(value);
+    }
+};
+
+// --------------------------- HELPER FUNCTIONS --------------------------- //
+fn kindOf(event: RawEventThreaded) RecordKind {
+    return switch (event) {
+        .KeyDown => .KeyDown,
+        .KeyUp => .KeyUp,
+        .WindowClose => .WindowClose,
+        .WindowDestroy => .WindowDestroy,
+        .WindowResize => .WindowResize,
+        .MouseMove => .MouseMove,
+        .WindowFocusGain => .WindowFocusGain,
+        .WindowFocusLose => .WindowFocusLose,
+        .Update => .Update,
+        .PostRender => .PostRender,
+    };
+}
+
+fn appendInt(comptime T: type, list: *ArrayList(u8), allocator: Allocator, value: T) !void {
+    var bytes: [@sizeOf(T)]u8 = undefined;
+    std.mem.writeInt(T, &bytes, value, .little);
+    try list.appendSlice(allocator, &bytes);
+}
+
+fn appendVarInt(list: *ArrayList(u8), allocator: Allocator, value: u64) !void {
+    var remaining = value;
+
+    while (remaining >= 0x80) {
+        try list.append(allocator, @as(u8, @truncate(remaining)) | 0x80);
+        remaining >>= 7;
+    }
+
+    try list.append(allocator, @truncate(remaining));
+}
+
+pub const RecordingError = error{
+    InvalidRecording,
+    UnsupportedRecordingVersion,
+    UnexpectedEndOfRecording,
+};
@@ -0,0 +1,487 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const types = @import("../utils/types.zig");
+const DeltaTime = types.Deltatime;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Length of a single tick in milliseconds
+const tick_ms: f64 = 1.0;
+
+const slot_bits = 6;
+const slot_count = 1 << slot_bits;
+const slot_mask: u64 = slot_count - 1;
+
+/// 4 levels of 64 slots cover 2^24 ticks (~4.6 hours). Longer delays are parked in the last level and
+/// re-inserted each time that slot cascades until they fit.
+const level_count = 4;
+const max_delay_ticks: u64 = (1 << (slot_bits * level_count)) - 1;
+
+const none: u32 = std.math.maxInt(u32);
+
+pub const TimerCallbackFn = *const fn (TimerHandle, ?*anyopaque) anyerror!void;
+
+/// Handle of a scheduled timer. Stays valid for repeating timers until they are cancelled.
+pub const TimerHandle = struct {
+    index: u32,
+    generation: u32,
+
+    pub const invalid = TimerHandle{ .index = none, .generation = 0 };
+};
+
+pub const TimerDispatch = enum {
+    MainThread, // Runs sequentially on the thread that advances the wheel
+    WorkerThread, // Runs in parallel with other worker timers that expired in the same frame
+};
+
+pub const TimerOptions = struct {
+    repeat_interval: ?DeltaTime = null, // Seconds between repeats, timer fires once when null
+    dispatch: TimerDispatch = .MainThread,
+};
+
+const TimerState = enum {
+    Free,
+    Scheduled,
+    Expired,
+};
+
+const TimerNode = struct {
+    callback: TimerCallbackFn,
+    data: ?*anyopaque,
+
+    expires_at: u64,
+    repeat_ticks: u64,
+    dispatch: TimerDispatch,
+
+    generation: u32,
+    state: TimerState,
+
+    // Slot the node is linked into, lets unlink fix up the list head in O(1)
+    level: u8,
+    slot: u8,
+
+    prev: u32,
+    next: u32,
+};
+
+/// Hierarchical timer wheel with O(1) schedule and cancel.
+/// Timers that are only waiting cost nothing until the tick they expire on.
+pub const TimerWheel = struct {
+    allocator: Allocator,
+    mutex: std.Thread.Mutex,
+
+    nodes: ArrayList(TimerNode),
+    free_head: u32,
+
+    slots: [level_count][slot_count]u32,
+    occupied: [level_count]u64, // Bit per slot that has timers linked into it, lets empty ticks be skipped in bulk
+
+    current_tick: u64,
+    pending_ms: f64,
+
+    expired: ArrayList(TimerHandle),
+    worker_pool: ?*std.Thread.Pool,
+
+    pub fn create() !*TimerWheel {
+        const wheel = try cAlloc(TimerWheel);
+        wheel.* = TimerWheel{
+            .allocator = std.heap.c_allocator,
+            .mutex = std.Thread.Mutex{},
+            .nodes = ArrayList(TimerNode){},
+            .free_head = none,
+            .slots = [_][slot_count]u32{[_]u32{none} ** slot_count} ** level_count,
+            .occupied = .{0} ** level_count,
+            .current_tick = 0,
+            .pending_ms = 0,
+            .expired = ArrayList(TimerHandle){},
+            .worker_pool = null,
+        };
+
+        return wheel;
+    }
+
+    pub fn destroy(self: *TimerWheel) void {
+        if (self.worker_pool) |pool| {
+            pool.deinit();
+            cFree(pool);
+        }
+
+        self.nodes.deinit(self.allocator);
+        self.expired.deinit(self.allocator);
+        cFree(self);
+    }
+
+    /// Schedules callback to run after `delay` seconds
+    ///
+    /// # Arguments
+    /// - `delay`: Seconds until the first call
+    /// - `callback`: Function to call
+    /// - `data`: User data passed to callback
+    /// - `options`: Repeat interval and dispatch mode
+    ///
+    /// # Returns
+    /// - `TimerHandle`: Handle that can be passed to `cancel()`
+    pub fn schedule(self: *TimerWheel, delay: DeltaTime, callback: TimerCallbackFn, data: ?*anyopaque, options: TimerOptions) !TimerHandle {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const index = try self.allocateNode();
+        const node = &self.nodes.items[index];
+
+        node.callback = callback;
+        node.data = data;
+        node.expires_at = self.current_tick + secondsToTicks(delay);
+        node.repeat_ticks = if (options.repeat_interval) |interval| @max(secondsToTicks(interval), 1) else 0;
+        node.dispatch = options.dispatch;
+        node.state = .Scheduled;
+
+        self.insert(index);
+
+        return TimerHandle{ .index = index, .generation = node.generation };
+    }
+
+    /// Cancels timer. Safe to call with stale handles and from inside timer callbacks.
+    ///
+    /// # Returns
+    /// - `true` if timer was still pending
+    pub fn cancel(self: *TimerWheel, handle: TimerHandle) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const node = self.getNode(handle) orelse return false;
+
+        switch (node.state) {
+            .Scheduled => self.unlink(handle.index),
+            .Expired => {}, // Already detached, will be skipped when expired timers are run
+            .Free => return false,
+        }
+
+        self.releaseNode(handle.index);
+        return true;
+    }
+
+    pub fn isPending(self: *TimerWheel, handle: TimerHandle) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        return self.getNode(handle) != null;
+    }
+
+    /// Whether any timer is waiting to expire, i.e. frames have to keep advancing the wheel
+    pub fn hasScheduled(self: *TimerWheel) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        return !self.isEmpty();
+    }
+
+    /// Advances wheel by `delta` seconds and runs every timer that expired in the meantime.
+    /// Meant to be called once per frame.
+    pub fn advance(self: *TimerWheel, delta: DeltaTime) void {
+        self.collectExpired(delta);
+        if (self.expired.items.len == 0) return;
+
+        var has_worker_timers = false;
+
+        for (self.expired.items) |handle| {
+            const dispatch = self.peekDispatch(handle) orelse continue;
+
+            if (dispatch == .MainThread) {
+                self.runTimer(handle);
+            } else {
+                has_worker_timers = true;
+            }
+        }
+
+        if (has_worker_timers) self.runWorkerTimers();
+
+        self.expired.clearRetainingCapacity();
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn secondsToTicks(seconds: DeltaTime) u64 {
+        if (!(seconds > 0)) return 0;
+
+        const ticks: f64 = @as(f64, seconds) * 1000.0 / tick_ms;
+        if (ticks >= @as(f64, @floatFromInt(std.math.maxInt(u32)))) return std.math.maxInt(u32);
+
+        return @intFromFloat(@ceil(ticks));
+    }
+
+    fn collectExpired(self: *TimerWheel, delta: DeltaTime) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.pending_ms += @max(@as(f64, delta) * 1000.0, 0);
+        const ticks: u64 = @intFromFloat(@floor(self.pending_ms / tick_ms));
+        self.pending_ms -= @as(f64, @floatFromInt(ticks)) * tick_ms;
+
+        // Long frames, e.g. the first one after frames were paused, mostly cross ticks nothing happens on
+        var remaining = ticks;
+        while (remaining > 0) {
+            const idle = self.getIdleTickCount(remaining);
+            if (idle > 0) {
+                self.current_tick += idle;
+                remaining -= idle;
+                continue;
+            }
+
+            self.processTick();
+            remaining -= 1;
+        }
+    }
+
+    fn isEmpty(self: *const TimerWheel) bool {
+        for (self.occupied) |bits| {
+            if (bits != 0) return false;
+        }
+
+        return true;
+    }
+
+    /// Ticks from `current_tick` on, up to `limit`, that would neither expire nor cascade any timer
+    fn getIdleTickCount(self: *const TimerWheel, limit: u64) u64 {
+        if (self.isEmpty()) return limit;
+
+        const end = self.current_tick + limit;
+        var tick = self.current_tick;
+
+        while (tick < end) {
+            const index = tick & slot_mask;
+            if (index == 0 and self.cascadesAt(tick)) break;
+
+            const ahead = self.occupied[0] >> @intCast(index);
+            const free: u64 = if (ahead == 0) slot_count - index else @ctz(ahead);
+            if (free == 0) break;
+
+            tick += @min(free, end - tick);
+        }
+
+        return tick - self.current_tick;
+    }
+
+    /// Whether `processTick()` would pull timers down from higher levels at `tick`, mirrors its cascade loop
+    fn cascadesAt(self: *const TimerWheel, tick: u64) bool {
+        var level: usize = 1;
+        while (level < level_count) : (level += 1) {
+            const level_index = (tick >> @intCast(slot_bits * level)) & slot_mask;
+            if (self.occupied[level] & (@as(u64, 1) << @intCast(level_index)) != 0) return true;
+
+            if (level_index != 0) break;
+        }
+
+        return false;
+    }
+
+    fn processTick(self: *TimerWheel) void {
+        const index = self.current_tick & slot_mask;
+
+        // Pull timers from higher levels down when lower level wraps around
+        if (index == 0) {
+            var level: usize = 1;
+            while (level < level_count) : (level += 1) {
+                const level_index = (self.current_tick >> @intCast(slot_bits * level)) & slot_mask;
+                self.cascade(level, level_index);
+
+                if (level_index != 0) break;
+            }
+        }
+
+        var current = self.slots[0][index];
+        self.slots[0][index] = none;
+        self.occupied[0] &= ~(@as(u64, 1) << @intCast(index));
+
+        while (current != none) {
+            const node = &self.nodes.items[current];
+            const next = node.next;
+
+            node.state = .Expired;
+            node.prev = none;
+            node.next = none;
+
+            self.expired.append(self.allocator, TimerHandle{ .index = current, .generation = node.generation }) catch {
+                std.log.err("Failed to queue expired timer", .{});
+            };
+
+            current = next;
+        }
+
+        self.current_tick += 1;
+    }
+
+    fn cascade(self: *TimerWheel, level: usize, index: u64) void {
+        var current = self.slots[level][index];
+        self.slots[level][index] = none;
+        self.occupied[level] &= ~(@as(u64, 1) << @intCast(index));
+
+        while (current != none) {
+            const next = self.nodes.items[current].next;
+            self.insert(current);
+            current = next;
+        }
+    }
+
+    fn insert(self: *TimerWheel, index: u32) void {
+        const node = &self.nodes.items[index];
+        const delay = node.expires_at -| self.current_tick;
+
+        var level: usize = 0;
+        while (level < level_count - 1 and delay >= (@as(u64, 1) << @intCast(slot_bits * (level + 1)))) {
+            level += 1;
+        }
+
+        const expires_at = if (delay > max_delay_ticks) self.current_tick + max_delay_ticks else @max(node.expires_at, self.current_tick);
+        const slot = (expires_at >> @intCast(slot_bits * level)) & slot_mask;
+
+        node.level = @intCast(level);
+        node.slot = @intCast(slot);
+        node.prev = none;
+        node.next = self.slots[level][slot];
+        if (node.next != none) self.nodes.items[node.next].prev = index;
+        self.slots[level][slot] = index;
+        self.occupied[level] |= @as(u64, 1) << @intCast(slot);
+    }
+
+    fn unlink(self: *TimerWheel, index: u32) void {
+        const node = &self.nodes.items[index];
+
+        if (node.prev != none) {
+            self.nodes.items[node.prev].next = node.next;
+        } else {
+            self.slots[node.level][node.slot] = node.next;
+            if (node.next == none) self.occupied[node.level] &= ~(@as(u64, 1) << @intCast(node.slot));
+        }
+
+        if (node.next != none) self.nodes.items[node.next].prev = node.prev;
+
+        node.prev = none;
+        node.next = none;
+    }
+
+    fn allocateNode(self: *TimerWheel) !u32 {
+        if (self.free_head != none) {
+            const index = self.free_head;
+            self.free_head = self.nodes.items[index].next;
+            return index;
+        }
+
+        const index: u32 = @intCast(self.nodes.items.len);
+        try self.nodes.append(self.allocator, TimerNode{
+            .callback = undefined,
+            .data = null,
+            .expires_at = 0,
+            .repeat_ticks = 0,
+            .dispatch = .MainThread,
+            .generation = 0,
+            .state = .Free,
+            .level = 0,
+            .slot = 0,
+            .prev = none,
+            .next = none,
+        });
+
+        return index;
+    }
+
+    fn releaseNode(self: *TimerWheel, index: u32) void {
+        const node = &self.nodes.items[index];
+
+        node.state = .Free;
+        node.generation +%= 1; // Invalidates all outstanding handles
+        node.prev = none;
+        node.next = self.free_head;
+        self.free_head = index;
+    }
+
+    fn getNode(self: *TimerWheel, handle: TimerHandle) ?*TimerNode {
+        if (handle.index >= self.nodes.items.len) return null;
+
+        const node = &self.nodes.items[handle.index];
+        if (node.generation != handle.generation or node.state == .Free) return null;
+
+        return node;
+    }
+
+    fn peekDispatch(self: *TimerWheel, handle: TimerHandle) ?TimerDispatch {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const node = self.getNode(handle) orelse return null;
+        return node.dispatch;
+    }
+
+    /// Runs expired timer and reschedules or frees it afterwards
+    fn runTimer(self: *TimerWheel, handle: TimerHandle) void {
+        self.mutex.lock();
+        const node = self.getNode(handle) orelse {
+            self.mutex.unlock();
+            return;
+        };
+
+        if (node.state != .Expired) {
+            self.mutex.unlock();
+            return;
+        }
+
+        const callback = node.callback;
+        const data = node.data;
+        self.mutex.unlock();
+
+        // Lock is not held while callback runs so it can schedule and cancel timers
+        callback(handle, data) catch |e| {
+            std.log.err("Timer callback failed: {}", .{e});
+        };
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        // Callback may have cancelled its own timer
+        const after = self.getNode(handle) orelse return;
+        if (after.state != .Expired) return;
+
+        if (after.repeat_ticks > 0) {
+            after.expires_at = after.expires_at + after.repeat_ticks;
+            after.state = .Scheduled;
+            self.insert(handle.index);
+        } else {
+            self.releaseNode(handle.index);
+        }
+    }
+
+    fn runWorkerTimers(self: *TimerWheel) void {
+        const pool = self.getWorkerPool() catch |e| {
+            std.log.err("Failed to start timer worker threads, running on current thread: {}", .{e});
+
+            for (self.expired.items) |handle| self.runTimer(handle);
+            return;
+        };
+
+        var wait_group = std.Thread.WaitGroup{};
+
+        for (self.expired.items) |handle| {
+            const dispatch = self.peekDispatch(handle) orelse continue;
+
+            if (dispatch == .WorkerThread)
+                pool.spawnWg(&wait_group, runTimer, .{ self, handle });
+        }
+
+        pool.waitAndWork(&wait_group);
+    }
+
+    fn getWorkerPool(self: *TimerWheel) !*std.Thread.Pool {
+        if (self.worker_pool) |pool| return pool;
+
+        const pool = try cAlloc(std.Thread.Pool);
+        errdefer cFree(pool);
+
+        try pool.init(.{ .allocator = self.allocator });
+        self.worker_pool = pool;
+
+        return pool;
+    }
+};
@@ -28,6 +28,7 @@ pub const InputSystem = struct {
 
         self.pressed_keys.append(self.arena_allocator.allocator(), key) catch |e| {
             std.log.err("Failed to add key to pressed keys: {}", .{e});
+            return;
         };
     }
 
@@ -0,0 +1,227 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const Material = @import("material.zig").Material;
+
+/// Most parameters a single block can hold, keeps blocks fixed size so they hash and compare without allocating
+pub const max_params = 8;
+
+pub const ParamValue = union(enum) {
+    Int: i32,
+    Float: f32,
+    Vec2: [2]f32,
+    Vec3: [3]f32,
+    Vec4: [4]f32,
+};
+
+pub const Param = struct {
+    name: []const u8, // Uniform name, static because it comes from a field name
+    value: ParamValue,
+};
+
+/// Uniform values of a material instance, built from a plain struct whose field names are uniform names, e.g.
+/// `ParamBlock.from(.{ .u_Tint = [4]f32{ 1, 0, 0, 1 }, .u_Cutoff = @as(f32, 0.5) })`.
+/// Supported field types are `i32`, `f32` and `[2|3|4]f32`.
+pub const ParamBlock = struct {
+    params: [max_params]Param = undefined,
+    count: usize = 0,
+
+    pub const empty = ParamBlock{};
+
+    pub fn from(values: anytype) ParamBlock {
+        const fields = @typeInfo(@TypeOf(values)).@"struct".fields;
+        if (fields.len > max_params) @compileError("Material parameter block has more than max_params fields");
+
+        var block = ParamBlock{};
+        inline for (fields) |field| {
+            block.params[block.count] = Param{
+                .name = field.name,
+                .value = toValue(field.type, @field(values, field.name)),
+            };
+            block.count += 1;
+        }
+
+        return block;
+    }
+
+    /// Sets `name` to `value`, replacing its current value. `name` has to outlive the block.
+    ///
+    /// # Errors
+    /// - `TooManyParams`: Block already holds `max_params` other parameters
+    pub fn set(self: *ParamBlock, name: []const u8, value: ParamValue) !void {
+        for (self.params[0..self.count]) |*param| {
+            if (std.mem.eql(u8, param.name, name)) {
+                param.value = value;
+                return;
+            }
+        }
+
+        if (self.count == max_params) return MaterialInstanceError.TooManyParams;
+
+        self.params[self.count] = Param{ .name = name, .value = value };
+        self.count += 1;
+    }
+
+    /// Whether `u_Tint` makes everything drawn with these parameters partially transparent
+    pub fn isTranslucent(self: *const ParamBlock) bool {
+        for (self.getParams()) |param| {
+            if (!std.mem.eql(u8, param.name, "u_Tint")) continue;
+
+            return switch (param.value) {
+                .Vec4 => |tint| tint[3] < 1.0,
+                else => false,
+            };
+        }
+
+        return false;
+    }
+
+    pub fn getParams(self: *const ParamBlock) []const Param {
+        return self.params[0..self.count];
+    }
+
+    /// Hash of names and values, blocks with equal parameters in the same order hash the same
+    pub fn hash(self: *const ParamBlock, seed: u64) u64 {
+        var hasher = std.hash.Wyhash.init(seed);
+        for (self.getParams()) |param| {
+            hasher.update(param.name);
+            hasher.update(&[_]u8{@intFromEnum(std.meta.activeTag(param.value))});
+            switch (param.value) {
+                inline else => |value| hasher.update(std.mem.asBytes(&value)),
+            }
+        }
+
+        return hasher.final();
+    }
+
+    pub fn eql(self: *const ParamBlock, other: *const ParamBlock) bool {
+        if (self.count != other.count) return false;
+
+        for (self.getParams(), other.getParams()) |a, b| {
+            if (!std.mem.eql(u8, a.name, b.name)) return false;
+            if (!std.meta.eql(a.value, b.value)) return false;
+        }
+
+        return true;
+    }
+
+    /// Uploads every parameter into `material`'s program, which has to be current.
+    /// Parameters the program does not use are skipped.
+    pub fn apply(self: *const ParamBlock, material: *const Material) void {
+        for (self.getParams()) |param| {
+            const location = material.getUniformLocation(param.name);
+            if (location < 0) continue;
+
+            switch (param.value) {
+                .Int => |value| c.glUniform1i(location, value),
+                .Float => |value| c.glUniform1f(location, value),
+                .Vec2 => |value| c.glUniform2f(location, value[0], value[1]),
+                .Vec3 => |value| c.glUniform3f(location, value[0], value[1], value[2]),
+                .Vec4 => |value| c.glUniform4f(location, value[0], value[1], value[2], value[3]),
+            }
+        }
+    }
+
+    fn toValue(comptime T: type, value: T) ParamValue {
+        return switch (T) {
+            i32, comptime_int => ParamValue{ .Int = value },
+            f32, comptime_float => ParamValue{ .Float = value },
+            [2]f32 => ParamValue{ .Vec2 = value },
+            [3]f32 => ParamValue{ .Vec3 = value },
+            [4]f32 => ParamValue{ .Vec4 = value },
+            else => @compileError("Unsupported material parameter type " ++ @typeName(T)),
+        };
+    }
+};
+
+/// Shared material together with its parameters. Instances are interned by `MaterialInstanceCache`,
+/// so sprites with the same material and parameters share one instance and batch together.
+pub const MaterialInstance = struct {
+    id: u16, // Small unique id used in render queue sort keys
+    material: *Material,
+    params: ParamBlock,
+    batch_key: u64, // Unique per instance, hash of material and parameters
+    is_translucent: bool, // Tint is partially transparent, sprites have to be blended in depth order
+
+    /// Makes `target` current and uploads parameters unless it already holds them.
+    /// `target` is `material` itself or one of its variants. Render thread only.
+    ///
+    /// # Returns
+    /// - `true` if program was not current already
+    pub fn bind(self: *const MaterialInstance, target: *Material) !bool {
+        const changed = try target.bind();
+
+        if (target.applied_params_key != self.batch_key) {
+            self.params.apply(target);
+            target.applied_params_key = self.batch_key;
+        }
+
+        return changed;
+    }
+};
+
+/// Interns material instances by batch key. Not thread safe, `Renderer` guards it with its material mutex.
+pub const MaterialInstanceCache = struct {
+    instances: std.AutoHashMap(u64, *MaterialInstance),
+    next_id: u16,
+
+    pub fn init() MaterialInstanceCache {
+        return MaterialInstanceCache{
+            .instances = std.AutoHashMap(u64, *MaterialInstance).init(std.heap.c_allocator),
+            .next_id = 0,
+        };
+    }
+
+    pub fn deinit(self: *MaterialInstanceCache) void {
+        var iterator = self.instances.valueIterator();
+        while (iterator.next()) |instance| cFree(instance.*);
+
+        self.instances.deinit();
+    }
+
+    /// Returns instance of `material` with `params` on top of its defaults, creating it on first use.
+    /// Every instance sets all default parameters, so nothing leaks from the instance drawn before it.
+    pub fn getOrCreate(self: *MaterialInstanceCache, material: *Material, overrides: *const ParamBlock) !*MaterialInstance {
+        var merged = material.default_params;
+        for (overrides.getParams()) |param| try merged.set(param.name, param.value);
+
+        const params = &merged;
+        var key = params.hash(@intFromPtr(material));
+
+        // Colliding keys are moved to the next free one, so a key always identifies a single instance
+        while (self.instances.get(key)) |existing| : (key +%= 1) {
+            if (existing.material == material and existing.params.eql(params)) return existing;
+        }
+
+        const instance = try cAlloc(MaterialInstance);
+        errdefer cFree(instance);
+
+        instance.* = MaterialInstance{
+            .id = self.next_id,
+            .material = material,
+            .params = params.*,
+            .batch_key = key,
+            .is_translucent = params.isTranslucent(),
+        };
+
+        try self.instances.put(key, instance);
+        self.next_id +%= 1;
+
+        return instance;
+    }
+
+    pub fn getCount(self: *const MaterialInstanceCache) usize {
+        return self.instances.count();
+    }
+};
+
+pub const MaterialInstanceError = error{
+    TooManyParams,
+};
@@ -5,81 +5,213 @@ const c = @cImport({
     @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
 });
 
+const GlState = @import("../renderer/gl/gl-state.zig").GlState;
+const FrameUniformLocations = @import("../renderer/gl/frame-constants.zig").FrameUniformLocations;
+const ProgramCache = @import("../renderer/gl/program-cache.zig").ProgramCache;
+const ParamBlock = @import("material-instance.zig").ParamBlock;
+const sprite_shader = @import("sprite-shader.zig");
+const ShaderFeatures = sprite_shader.ShaderFeatures;
+
+/// Longest uniform or attribute name reflected, including null terminator
+const max_variable_name_length = 64;
+
+/// Active uniform or attribute of a linked program
+pub const ShaderVariable = struct {
+    name_buffer: [max_variable_name_length]u8, // Null terminated, arrays are stored without `[0]`
+    name_length: usize,
+    location: i32,
+    gl_type: c.GLenum, // e.g. `GL_FLOAT_VEC4`, `GL_SAMPLER_2D`
+    size: i32, // Array length, 1 for non arrays
+
+    pub fn getName(self: *const ShaderVariable) []const u8 {
+        return self.name_buffer[0..self.name_length];
+    }
+};
+
+/// Program shared by every `MaterialInstance` created from it.
+/// Creating a material touches no GL, program is linked on the render thread the first time it is bound,
+/// so sprites can pick materials while the build stage records a frame.
+/// Uniforms and attributes are reflected once after linking, so nothing has to hardcode their locations.
 pub const Material = struct {
-    program: c.GLuint,
+    vertex_src: [:0]const u8,
+    fragment_src: [:0]const u8,
+
+    program: c.GLuint = 0,
+    is_linked: bool = false,
 
-    position_attribute_location: i32,
-    texture_attribute_location: i32,
+    uniforms: []const ShaderVariable = &.{}, // Only uniforms with a location, members of uniform blocks are left out
+    attributes: []const ShaderVariable = &.{},
 
-    model_matrix_uniform_location: i32,
-    view_matrix_uniform_location: i32,
-    projection_matrix_uniform_location: i32,
+    frame_uniforms: FrameUniformLocations = FrameUniformLocations.none,
+    default_params: ParamBlock = ParamBlock.empty, // Instances start from these, see `MaterialInstanceCache.getOrCreate()`
+    applied_params_key: ?u64 = null, // Batch key of the instance whose parameters the program holds, see `MaterialInstance.bind()`
 
-    texture_uniform_location: i32,
-    color_uniform_location: i32,
+    features: ShaderFeatures = .{}, // Features program was generated with, see `SpriteShader()`
+    build_variant: ?*const fn (ShaderFeatures) anyerror!*Material = null, // Materials without it have no variants and are never instanced
+    variants: [sprite_shader.variant_count]?*Material = .{null} ** sprite_shader.variant_count, // Built on first use
 
+    /// Creates material from sources, safe on any thread. Sources have to outlive it, sprite shader sources are static.
     pub fn create(vertex_src: [:0]const u8, fragment_src: [:0]const u8) !*Material {
-        const vs = try compile_shader(c.GL_VERTEX_SHADER, vertex_src);
-        const fs = try compile_shader(c.GL_FRAGMENT_SHADER, fragment_src);
-
-        const program = c.glCreateProgram();
-        c.glAttachShader(program, vs);
-        c.glAttachShader(program, fs);
-        c.glLinkProgram(program);
-
-        var success: c.GLint = 0;
-        c.glGetProgramiv(program, c.GL_LINK_STATUS, &success);
-        if (success == 0) {
-            var buf: [512]u8 = undefined;
-            var len: c.GLsizei = 0;
-            c.glGetProgramInfoLog(program, buf.len, &len, &buf);
-            std.debug.print("Program link failed: {s}\n", .{buf[0..@intCast(len)]});
-            return error.ProgramLinkFailed;
+        const material = try std.heap.c_allocator.create(Material);
+        material.* = Material{
+            .vertex_src = vertex_src,
+            .fragment_src = fragment_src,
+        };
+
+        return material;
+    }
+
+    /// Links program through program cache and reflects it, does nothing once linked. Render thread only.
+    ///
+    /// # Errors
+    /// - `ShaderCompileFailed`, `ProgramLinkFailed`: See `ProgramCache.loadOrLink()`
+    pub fn link(self: *Material) !void {
+        if (self.is_linked) return;
+
+        // Null renderer has no program to reflect, so parameters are never uploaded
+        if (GlState.get().isNull()) {
+            self.is_linked = true;
+            return;
         }
 
-        const pos_attr = c.glGetAttribLocation(program, "a_Position");
-        const tex_attr = c.glGetAttribLocation(program, "a_TexCoord");
+        const program = try ProgramCache.loadOrLink(self.vertex_src, self.fragment_src);
 
-        const model_loc = c.glGetUniformLocation(program, "u_Model");
-        const view_loc = c.glGetUniformLocation(program, "u_View");
-        const proj_loc = c.glGetUniformLocation(program, "u_Projection");
+        const uniforms = try reflect(program, .Uniform);
+        errdefer std.heap.c_allocator.free(uniforms);
 
-        const tex_loc = c.glGetUniformLocation(program, "u_Texture");
-        const color_loc = c.glGetUniformLocation(program, "u_Color");
+        const attributes = try reflect(program, .Attribute);
+        errdefer std.heap.c_allocator.free(attributes);
 
-        const material = try std.heap.c_allocator.create(Material);
-        material.* = Material{
-            .program = program,
+        self.program = program;
+        self.uniforms = uniforms;
+        self.attributes = attributes;
+        self.frame_uniforms = FrameUniformLocations.init(program);
+        self.is_linked = true;
 
-            .position_attribute_location = pos_attr,
-            .texture_attribute_location = tex_attr,
+        // Sampler never changes, every material samples its texture from unit 0
+        const texture_location = self.getUniformLocation("u_Texture");
+        if (texture_location >= 0) {
+            _ = GlState.get().useProgram(program);
+            c.glUniform1i(texture_location, 0);
+        }
+    }
 
-            .model_matrix_uniform_location = model_loc,
-            .view_matrix_uniform_location = view_loc,
-            .projection_matrix_uniform_location = proj_loc,
+    /// Returns variant of this material with `features`, compiling it through program cache on first use
+    ///
+    /// # Errors
+    /// - `VariantNotAvailable`: Material was not generated from `SpriteShader()`
+    pub fn getVariant(self: *Material, features: ShaderFeatures) !*Material {
+        if (features == self.features) return self;
 
-            .texture_uniform_location = tex_loc,
-            .color_uniform_location = color_loc,
-        };
+        const index = features.toIndex();
+        if (self.variants[index]) |variant| return variant;
 
-        return material;
+        const build = self.build_variant orelse return MaterialError.VariantNotAvailable;
+        const variant = try build(features);
+        self.variants[index] = variant;
+
+        return variant;
+    }
+
+    /// Cheapest program that draws a batch needing `features`. Alpha testing always follows this material.
+    /// Materials without variants draw everything themselves.
+    pub fn selectVariant(self: *Material, features: ShaderFeatures) !*Material {
+        if (self.build_variant == null) return self;
+
+        var wanted = features;
+        wanted.alpha_test = self.features.alpha_test;
+        return self.getVariant(wanted);
     }
 
-    fn compile_shader(kind: c.GLenum, source: [:0]const u8) !c.GLuint {
-        const shader = c.glCreateShader(kind);
-        const srcs = [_][*:0]const u8{source};
-        c.glShaderSource(shader, 1, &srcs, null);
-        c.glCompileShader(shader);
-
-        var success: c.GLint = 0;
-        c.glGetShaderiv(shader, c.GL_COMPILE_STATUS, &success);
-        if (success == 0) {
-            var buf: [512]u8 = undefined;
-            var len: c.GLsizei = 0;
-            c.glGetShaderInfoLog(shader, buf.len, &len, &buf);
-            std.debug.print("Shader compile failed: {s}\n", .{buf[0..@intCast(len)]});
-            return error.ShaderCompileFailed;
+    /// Links this material and every variant with its alpha testing ahead of time, so no batch compiles one mid frame.
+    /// Render thread only.
+    pub fn prewarmVariants(self: *Material) !void {
+        try self.link();
+        if (self.build_variant == null) return;
+
+        for (0..sprite_shader.variant_count) |index| {
+            const features: ShaderFeatures = @bitCast(@as(u4, @intCast(index)));
+            if (features.alpha_test != self.features.alpha_test) continue;
+
+            const variant = try self.getVariant(features);
+            try variant.link();
         }
-        return shader;
     }
+
+    pub fn findUniform(self: *const Material, name: []const u8) ?*const ShaderVariable {
+        return findVariable(self.uniforms, name);
+    }
+
+    /// Location of uniform `name`, -1 if program does not use it
+    pub fn getUniformLocation(self: *const Material, name: []const u8) i32 {
+        const uniform = self.findUniform(name) orelse return -1;
+        return uniform.location;
+    }
+
+    /// Location of attribute `name`, -1 if program does not use it
+    pub fn getAttributeLocation(self: *const Material, name: []const u8) i32 {
+        const attribute = findVariable(self.attributes, name) orelse return -1;
+        return attribute.location;
+    }
+
+    /// Makes this material's program current, linking it first if it was never drawn. Render thread only.
+    ///
+    /// # Returns
+    /// - `true` if program was not current already
+    pub fn bind(self: *Material) !bool {
+        try self.link();
+        return GlState.get().useProgram(self.program);
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn findVariable(variables: []const ShaderVariable, name: []const u8) ?*const ShaderVariable {
+        for (variables) |*variable| {
+            if (std.mem.eql(u8, variable.getName(), name)) return variable;
+        }
+
+        return null;
+    }
+
+    /// Lists active uniforms or attributes of `program`, caller owns returned slice
+    fn reflect(program: c.GLuint, comptime kind: enum { Uniform, Attribute }) ![]ShaderVariable {
+        var count: c.GLint = 0;
+        c.glGetProgramiv(program, if (kind == .Uniform) c.GL_ACTIVE_UNIFORMS else c.GL_ACTIVE_ATTRIBUTES, &count);
+
+        var variables = std.ArrayList(ShaderVariable){};
+        errdefer variables.deinit(std.heap.c_allocator);
+
+        for (0..@intCast(count)) |index| {
+            var variable: ShaderVariable = undefined;
+            var length: c.GLsizei = 0;
+
+            switch (kind) {
+                .Uniform => c.glGetActiveUniform(program, @intCast(index), max_variable_name_length, &length, &variable.size, &variable.gl_type, &variable.name_buffer),
+                .Attribute => c.glGetActiveAttrib(program, @intCast(index), max_variable_name_length, &length, &variable.size, &variable.gl_type, &variable.name_buffer),
+            }
+
+            // Arrays are reported as `name[0]`, users look them up by base name
+            var name = variable.name_buffer[0..@intCast(length)];
+            if (std.mem.endsWith(u8, name, "[0]")) name = name[0 .. name.len - 3];
+
+            variable.name_length = name.len;
+            variable.name_buffer[name.len] = 0;
+
+            const name_z: [*c]const u8 = &variable.name_buffer;
+            variable.location = switch (kind) {
+                .Uniform => c.glGetUniformLocation(program, name_z),
+                .Attribute => c.glGetAttribLocation(program, name_z),
+            };
+
+            // Members of uniform blocks and built-ins have no location
+            if (variable.location < 0) continue;
+
+            try variables.append(std.heap.c_allocator, variable);
+        }
+
+        return variables.toOwnedSlice(std.heap.c_allocator);
+    }
+};
+
+pub const MaterialError = error{
+    VariantNotAvailable,
 };
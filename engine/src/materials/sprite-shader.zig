@@ -0,0 +1,147 @@
+const std = @import("std");
+
+const Material = @import("material.zig").Material;
+const ParamBlock = @import("material-instance.zig").ParamBlock;
+
+/// Optional parts of the sprite shader. Every combination is generated at compile time, see `SpriteShader()`.
+pub const ShaderFeatures = packed struct(u4) {
+    textured: bool = true, // Samples `u_Texture`, untextured sprites skip the fetch
+    vertex_color: bool = true, // Multiplies by per sprite color, batches of white sprites skip it
+    alpha_test: bool = false, // Discards fragments below `u_AlphaCutoff`, chosen by material, never by renderer
+    instanced: bool = false, // Reads transform from per instance attributes, see `SpriteInstancer`
+
+    pub fn toIndex(self: ShaderFeatures) usize {
+        return @as(u4, @bitCast(self));
+    }
+};
+
+pub const variant_count = 1 << @bitSizeOf(ShaderFeatures);
+
+/// Attribute locations of batched variants, see `SpriteVertex`
+pub const BatchedAttributes = struct {
+    pub const position = 0;
+    pub const tex_coord = 1;
+    pub const color = 2;
+};
+
+/// Attribute locations of instanced variants, see `SpriteInstance`
+pub const InstancedAttributes = struct {
+    pub const position = 0;
+    pub const tex_coord = 1;
+    pub const transform_x = 2;
+    pub const transform_y = 3;
+    pub const color = 4;
+    pub const uv_rect = 5;
+};
+
+/// GLSL and Zig side bindings of sprite shader with `features`.
+/// Sources only declare what the features use, so e.g. an untextured variant has no sampler at all.
+/// `u_ViewProjection` comes from frame constants prelude injected by `ProgramCache`.
+pub fn SpriteShader(comptime features: ShaderFeatures) type {
+    return struct {
+        pub const Attributes = if (features.instanced) InstancedAttributes else BatchedAttributes;
+
+        /// Material parameters of this variant with their defaults, see `ParamBlock.from()`
+        pub const Params = if (features.alpha_test) struct {
+            u_Tint: [4]f32 = .{ 1.0, 1.0, 1.0, 1.0 },
+            u_AlphaCutoff: f32 = 0.5,
+        } else struct {
+            u_Tint: [4]f32 = .{ 1.0, 1.0, 1.0, 1.0 },
+        };
+
+        pub const vertex_source: [:0]const u8 = terminate(if (features.instanced) instanced_vertex_source else batched_vertex_source);
+
+        const batched_vertex_source =
+            "#version 330 core\n" ++
+            attribute("vec2", "a_Position", Attributes.position, true) ++
+            attribute("vec2", "a_TexCoord", Attributes.tex_coord, features.textured) ++
+            attribute("vec4", "a_Color", Attributes.color, features.vertex_color) ++
+            varyings("out") ++
+            "void main() {\n" ++
+            "    gl_Position = u_ViewProjection * vec4(a_Position, 0.0, 1.0);\n" ++
+            line("    v_TexCoord = a_TexCoord;", features.textured) ++
+            line("    v_Color = a_Color;", features.vertex_color) ++
+            "}\n";
+
+        // Static unit quad with transform, color and UV rect coming from per instance attributes
+        const instanced_vertex_source =
+            "#version 330 core\n" ++
+            attribute("vec2", "a_Position", Attributes.position, true) ++
+            attribute("vec2", "a_TexCoord", Attributes.tex_coord, features.textured) ++
+            attribute("vec3", "a_TransformX", Attributes.transform_x, true) ++
+            attribute("vec3", "a_TransformY", Attributes.transform_y, true) ++
+            attribute("vec4", "a_Color", Attributes.color, features.vertex_color) ++
+            attribute("vec4", "a_UvRect", Attributes.uv_rect, features.textured) ++
+            varyings("out") ++
+            "void main() {\n" ++
+            "    vec3 local = vec3(a_Position, 1.0);\n" ++
+            "    vec2 worldPos = vec2(dot(a_TransformX, local), dot(a_TransformY, local));\n" ++
+            "    gl_Position = u_ViewProjection * vec4(worldPos, 0.0, 1.0);\n" ++
+            line("    v_TexCoord = mix(a_UvRect.xy, a_UvRect.zw, a_TexCoord);", features.textured) ++
+            line("    v_Color = a_Color;", features.vertex_color) ++
+            "}\n";
+
+        pub const fragment_source: [:0]const u8 = terminate(fragment_body);
+
+        const fragment_body =
+            "#version 330 core\n" ++
+            "precision mediump float;\n" ++
+            varyings("in") ++
+            line("uniform sampler2D u_Texture;", features.textured) ++
+            "uniform vec4 u_Tint;\n" ++
+            line("uniform float u_AlphaCutoff;", features.alpha_test) ++
+            "void main() {\n" ++
+            "    vec4 color = u_Tint;\n" ++
+            line("    color *= texture(u_Texture, v_TexCoord);", features.textured) ++
+            line("    color *= v_Color;", features.vertex_color) ++
+            line("    if (color.a < u_AlphaCutoff) discard;", features.alpha_test) ++
+            "    gl_FragColor = color;\n" ++
+            "}\n";
+
+        fn varyings(comptime direction: []const u8) []const u8 {
+            return line(direction ++ " vec2 v_TexCoord;", features.textured) ++
+                line(direction ++ " vec4 v_Color;", features.vertex_color);
+        }
+    };
+}
+
+/// Creates material with sprite shader of `features`, every other variant is built from it on demand
+pub fn createSpriteMaterial(comptime features: ShaderFeatures) !*Material {
+    const material = try createVariant(features);
+    material.build_variant = createVariant;
+    material.default_params = ParamBlock.from(SpriteShader(features).Params{});
+
+    return material;
+}
+
+/// Creates variant with `features`, its program is linked when first bound. Picks generated sources for runtime `features`.
+pub fn createVariant(features: ShaderFeatures) anyerror!*Material {
+    switch (@as(u4, @bitCast(features))) {
+        inline else => |bits| {
+            const Shader = SpriteShader(@bitCast(bits));
+
+            const material = try Material.create(Shader.vertex_source, Shader.fragment_source);
+            material.features = features;
+            return material;
+        },
+    }
+}
+
+/// Sprites drawn white do not need vertex color, see `ShaderFeatures.vertex_color`
+pub fn isWhite(color: *const [4]f32) bool {
+    return color[0] == 1.0 and color[1] == 1.0 and color[2] == 1.0 and color[3] == 1.0;
+}
+
+// --------------------------- HELPER FUNCTIONS --------------------------- //
+fn attribute(comptime glsl_type: []const u8, comptime name: []const u8, comptime location: u32, comptime enabled: bool) []const u8 {
+    return line(std.fmt.comptimePrint("layout(location = {d}) in {s} {s};", .{ location, glsl_type, name }), enabled);
+}
+
+fn line(comptime text: []const u8, comptime enabled: bool) []const u8 {
+    return if (enabled) text ++ "\n" else "";
+}
+
+/// Concatenated slices lose their sentinel, GL wants null terminated sources
+fn terminate(comptime text: []const u8) [:0]const u8 {
+    return std.fmt.comptimePrint("{s}", .{text});
+}
@@ -0,0 +1,106 @@
+const std = @import("std");
+
+const App = @import("../app.zig").App;
+const getEnvOwned = @import("../utils/platform.zig").getEnvOwned;
+const Event = @import("../event-system/event_dispatcher.zig").EventDispatcher;
+
+/// Called once when `frame_limit` is reached, right before the process exits
+pub const FinishedCallback = *const fn (data: ?*anyopaque, frame_count: u64, elapsed_ns: u64) void;
+
+/// Frame clock of platforms without a compositor to pace them, see `Headless` and `NullPlatform`.
+/// Runs the same per frame sequence compositor driven platforms run from their frame callback.
+///
+/// Environment, `PREFIX` being the one passed to `init()`:
+/// - `PREFIX_FPS`: Frames per second, 0 runs frames back to back
+/// - `PREFIX_FRAMES`: Exits after this many frames, for benchmarks
+pub const FrameLoop = struct {
+    app: *App,
+    on_request_frame: *Event(void, *anyopaque),
+    name: []const u8, // Shown in the log line printed when the run finishes
+
+    frame_interval_ns: u64,
+    frame_limit: ?u64,
+
+    on_finished: ?FinishedCallback = null,
+    on_finished_data: ?*anyopaque = null,
+
+    /// # Arguments
+    /// - `name`: Platform name used in logs
+    /// - `env_prefix`: Prefix of `_FPS` and `_FRAMES` environment variables
+    /// - `default_frame_rate`: Frames per second when `PREFIX_FPS` is not set, 0 runs frames back to back
+    pub fn init(on_request_frame: *Event(void, *anyopaque), name: []const u8, comptime env_prefix: []const u8, default_frame_rate: u64) FrameLoop {
+        const frame_rate = readEnvInt(env_prefix ++ "_FPS") orelse default_frame_rate;
+
+        return FrameLoop{
+            .app = App.get(),
+            .on_request_frame = on_request_frame,
+            .name = name,
+            .frame_interval_ns = if (frame_rate == 0) 0 else std.time.ns_per_s / frame_rate,
+            .frame_limit = readEnvInt(env_prefix ++ "_FRAMES"),
+        };
+    }
+
+    /// Runs frames until `frame_limit` is reached, forever without one. Must be called on the thread that owns GL context.
+    pub fn run(self: *FrameLoop) void {
+        // Renderer subscribes right after window is returned, wait for it so the first frames are not lost
+        while (self.on_request_frame.entries.count() == 0) {
+            std.Thread.sleep(std.time.ns_per_ms);
+        }
+
+        var timer = std.time.Timer.start() catch unreachable;
+        var last_frame_ns: u64 = 0;
+        var next_frame_ns: u64 = 0;
+        var frame_count: u64 = 0;
+
+        while (true) {
+            const now = timer.read();
+            if (now < next_frame_ns) {
+                std.Thread.sleep(next_frame_ns - now);
+            }
+
+            const frame_start = timer.read();
+            const delta: f32 = @floatCast(@as(f64, @floatFromInt(frame_start - last_frame_ns)) / std.time.ns_per_s);
+            last_frame_ns = frame_start;
+
+            // Late frames are not caught up, clock restarts from the frame that was actually run
+            next_frame_ns = @max(next_frame_ns + self.frame_interval_ns, frame_start);
+
+            self.app.event_system.flushQueuedEvents();
+
+            const frame_delta = self.app.event_system.beginFrame(delta);
+            self.on_request_frame.dispatch({}) catch |e| {
+                std.log.err("Failed to dispatch frame event: {}", .{e});
+            };
+            self.app.input_system.beginFrame() catch {};
+            self.app.event_system.endFrame(frame_delta);
+
+            frame_count += 1;
+            if (self.frame_limit) |limit| {
+                if (frame_count >= limit) {
+                    // Last frames are still being submitted, totals and exit must not race them
+                    self.app.renderer.stopRenderThread();
+
+                    const elapsed_ns = timer.read();
+                    std.log.info("{s} run finished after {} frames in {d:.3}s", .{ self.name, frame_count, @as(f64, @floatFromInt(elapsed_ns)) / std.time.ns_per_s });
+
+                    if (self.on_finished) |on_finished| on_finished(self.on_finished_data, frame_count, elapsed_ns);
+
+                    self.app.event_system.shutdown();
+                    std.process.exit(0);
+                }
+            }
+        }
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn readEnvInt(name: []const u8) ?u64 {
+        const allocator = std.heap.c_allocator;
+        const value = getEnvOwned(allocator, name) orelse return null;
+        defer allocator.free(value);
+
+        return std.fmt.parseInt(u64, value, 10) catch {
+            std.log.warn("Ignoring {s}={s}, expected a whole number", .{ name, value });
+            return null;
+        };
+    }
+};
@@ -0,0 +1,214 @@
+const std = @import("std");
+
+const Event = @import("../../event-system/event_dispatcher.zig").EventDispatcher;
+const GlContext = @import("../../renderer/gl/gl-context.zig").GlContext;
+const Gl = @import("../../renderer/gl/gl.zig").Gl;
+const Window = @import("../../renderer/window.zig").Window;
+const Caster = @import("../../utils/caster.zig");
+const FrameLoop = @import("../frame-loop.zig").FrameLoop;
+
+const c = @cImport({
+    @cInclude("EGL/egl.h");
+});
+
+const c_glad = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+/// `EGL_MESA_platform_surfaceless`, display that needs no window system at all
+const egl_platform_surfaceless_mesa = 0x31DD;
+
+/// Frames per second of the internal clock when `GLAZE_HEADLESS_FPS` is not set, 0 runs frames back to back
+const default_frame_rate = 60;
+
+/// Offscreen platform for build machines: EGL context on a pbuffer, or surfaceless with a framebuffer object,
+/// which Mesa's llvmpipe provides without a GPU. Frames are driven by an internal clock instead of a compositor.
+///
+/// Environment:
+/// - `GLAZE_HEADLESS_FPS`: Frames per second, 0 runs as fast as possible
+/// - `GLAZE_HEADLESS_FRAMES`: Exits after this many frames, for benchmarks
+pub const Headless = struct {
+    frame_event_dispatcher: *Event(void, *anyopaque),
+
+    egl_display: c.EGLDisplay = c.EGL_NO_DISPLAY,
+    egl_context: c.EGLContext = c.EGL_NO_CONTEXT,
+    egl_surface: c.EGLSurface = c.EGL_NO_SURFACE, // No surface when only a surfaceless context could be made
+    egl_config: c.EGLConfig = null,
+
+    framebuffer: c_glad.GLuint = 0, // Render target of surfaceless contexts
+    renderbuffer: c_glad.GLuint = 0,
+
+    gl: ?*Gl = null,
+    window: ?*Window = null,
+    width: i32,
+    height: i32,
+
+    frame_loop: FrameLoop,
+
+    pub fn initWindow(width: i32, height: i32, _: [*:0]const u8) anyerror!*Window {
+        var allocator = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+
+        const frame_event_dispatcher = try Event(void, *anyopaque).create();
+
+        const headless = try allocator.allocator().create(Headless);
+        headless.* = Headless{
+            .frame_event_dispatcher = frame_event_dispatcher,
+            .width = width,
+            .height = height,
+            .frame_loop = FrameLoop.init(frame_event_dispatcher, "Headless", "GLAZE_HEADLESS", default_frame_rate),
+        };
+
+        const window = try allocator.allocator().create(Window);
+        headless.window = window;
+
+        var failed = std.atomic.Value(bool).init(false);
+        _ = try std.Thread.spawn(.{}, run, .{ headless, &failed });
+
+        // Context is created and made current on the frame thread, same as with a compositor
+        while (@atomicLoad(?*Gl, &headless.gl, .acquire) == null) {
+            if (failed.load(.acquire)) return HeadlessError.EglInitFailed;
+            std.Thread.sleep(10 * std.time.ns_per_ms);
+        }
+
+        window.* = Window{
+            .gl = headless.gl.?,
+            .on_request_frame = frame_event_dispatcher,
+            .width = width,
+            .height = height,
+        };
+        return window;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn run(self: *Headless, failed: *std.atomic.Value(bool)) void {
+        self.initEgl() catch |e| {
+            std.log.err("Headless EGL initialization failed: {}", .{e});
+            failed.store(true, .release);
+            return;
+        };
+
+        const gl = self.createGl() catch |e| {
+            std.log.err("Headless GL initialization failed: {}", .{e});
+            failed.store(true, .release);
+            return;
+        };
+
+        if (self.egl_surface == c.EGL_NO_SURFACE) self.createFramebuffer();
+
+        @atomicStore(?*Gl, &self.gl, gl, .release);
+
+        self.frame_loop.run();
+    }
+
+    fn initEgl(self: *Headless) !void {
+        // Surfaceless platform needs no X or Wayland server, default display is the fallback for older drivers
+        self.egl_display = c.eglGetPlatformDisplay(egl_platform_surfaceless_mesa, null, null);
+        if (self.egl_display == c.EGL_NO_DISPLAY) self.egl_display = c.eglGetDisplay(@as(c.EGLNativeDisplayType, null));
+        if (self.egl_display == c.EGL_NO_DISPLAY) return HeadlessError.EglInitFailed;
+
+        if (c.eglInitialize(self.egl_display, null, null) == 0) return HeadlessError.EglInitFailed;
+
+        // Desktop GL matches what shaders are written against, llvmpipe supports it. GLES2 is the same fallback Wayland uses.
+        const uses_desktop_gl = c.eglBindAPI(c.EGL_OPENGL_API) != 0;
+        if (!uses_desktop_gl and c.eglBindAPI(c.EGL_OPENGL_ES_API) == 0) return HeadlessError.EglInitFailed;
+
+        const renderable_type: c.EGLint = if (uses_desktop_gl) c.EGL_OPENGL_BIT else c.EGL_OPENGL_ES2_BIT;
+
+        // Pbuffer config first, any config works for a surfaceless context
+        var config_count: c.EGLint = 0;
+        const pbuffer_attribs = [_]c.EGLint{ c.EGL_SURFACE_TYPE, c.EGL_PBUFFER_BIT, c.EGL_RED_SIZE, 8, c.EGL_GREEN_SIZE, 8, c.EGL_BLUE_SIZE, 8, c.EGL_ALPHA_SIZE, 8, c.EGL_RENDERABLE_TYPE, renderable_type, c.EGL_NONE };
+        const any_attribs = [_]c.EGLint{ c.EGL_RENDERABLE_TYPE, renderable_type, c.EGL_NONE };
+
+        const has_pbuffer_config = c.eglChooseConfig(self.egl_display, &pbuffer_attribs, &self.egl_config, 1, &config_count) != 0 and config_count > 0;
+        if (!has_pbuffer_config) {
+            if (c.eglChooseConfig(self.egl_display, &any_attribs, &self.egl_config, 1, &config_count) == 0 or config_count < 1) return HeadlessError.EglInitFailed;
+        }
+
+        const es_context_attribs = [_]c.EGLint{ c.EGL_CONTEXT_CLIENT_VERSION, 2, c.EGL_NONE };
+        const context_attribs: [*c]const c.EGLint = if (uses_desktop_gl) null else &es_context_attribs;
+        self.egl_context = c.eglCreateContext(self.egl_display, self.egl_config, c.EGL_NO_CONTEXT, context_attribs);
+        if (self.egl_context == c.EGL_NO_CONTEXT) return HeadlessError.EglInitFailed;
+
+        if (has_pbuffer_config) {
+            const surface_attribs = [_]c.EGLint{ c.EGL_WIDTH, self.width, c.EGL_HEIGHT, self.height, c.EGL_NONE };
+            self.egl_surface = c.eglCreatePbufferSurface(self.egl_display, self.egl_config, &surface_attribs);
+        }
+
+        // Surfaceless contexts (EGL_KHR_surfaceless_context) render into a framebuffer object instead
+        if (c.eglMakeCurrent(self.egl_display, self.egl_surface, self.egl_surface, self.egl_context) == 0) return HeadlessError.EglInitFailed;
+    }
+
+    fn createGl(self: *Headless) !*Gl {
+        const fns = struct {
+            fn swapBuffers(ctx: *GlContext) anyerror!void {
+                const inner_self = try Caster.castFromNullableAnyopaque(Headless, ctx.data);
+
+                if (inner_self.egl_surface != c.EGL_NO_SURFACE) _ = c.eglSwapBuffers(inner_self.egl_display, inner_self.egl_surface);
+
+                // Nothing presents the frame, wait for it so frame time includes rendering like it would with vsync
+                c_glad.glFinish();
+            }
+
+            fn loadGlad(_: *GlContext) anyerror!void {
+                if (c_glad.gladLoadGL(c.eglGetProcAddress) == 0) return HeadlessError.GlLoadFailed;
+            }
+
+            fn destroy(ctx: *GlContext) void {
+                const inner_self = Caster.castFromNullableAnyopaque(Headless, ctx.data) catch return;
+
+                _ = c.eglMakeCurrent(inner_self.egl_display, c.EGL_NO_SURFACE, c.EGL_NO_SURFACE, c.EGL_NO_CONTEXT);
+                if (inner_self.egl_surface != c.EGL_NO_SURFACE) _ = c.eglDestroySurface(inner_self.egl_display, inner_self.egl_surface);
+                _ = c.eglDestroyContext(inner_self.egl_display, inner_self.egl_context);
+                _ = c.eglTerminate(inner_self.egl_display);
+            }
+
+            // Framebuffer object is context state, it stays bound when context moves between threads
+            fn makeCurrent(ctx: *GlContext) anyerror!void {
+                const inner_self = try Caster.castFromNullableAnyopaque(Headless, ctx.data);
+                if (c.eglMakeCurrent(inner_self.egl_display, inner_self.egl_surface, inner_self.egl_surface, inner_self.egl_context) == 0) return HeadlessError.EglInitFailed;
+            }
+
+            fn releaseCurrent(ctx: *GlContext) void {
+                const inner_self = Caster.castFromNullableAnyopaque(Headless, ctx.data) catch return;
+                _ = c.eglMakeCurrent(inner_self.egl_display, c.EGL_NO_SURFACE, c.EGL_NO_SURFACE, c.EGL_NO_CONTEXT);
+            }
+        };
+
+        const page_allocator = std.heap.page_allocator;
+
+        const context = try page_allocator.create(GlContext);
+        context.* = GlContext{
+            .destroy = fns.destroy,
+            .swap_buffers = fns.swapBuffers,
+            .load_glad = fns.loadGlad,
+            .make_current = fns.makeCurrent,
+            .release_current = fns.releaseCurrent,
+            .data = self,
+        };
+
+        const gl = try page_allocator.create(Gl);
+        gl.* = try Gl.init(context);
+
+        return gl;
+    }
+
+    /// Color target for surfaceless contexts, stays bound as draw framebuffer for the whole run
+    fn createFramebuffer(self: *Headless) void {
+        c_glad.glGenRenderbuffers(1, &self.renderbuffer);
+        c_glad.glBindRenderbuffer(c_glad.GL_RENDERBUFFER, self.renderbuffer);
+        c_glad.glRenderbufferStorage(c_glad.GL_RENDERBUFFER, c_glad.GL_RGBA8, self.width, self.height);
+
+        c_glad.glGenFramebuffers(1, &self.framebuffer);
+        c_glad.glBindFramebuffer(c_glad.GL_FRAMEBUFFER, self.framebuffer);
+        c_glad.glFramebufferRenderbuffer(c_glad.GL_FRAMEBUFFER, c_glad.GL_COLOR_ATTACHMENT0, c_glad.GL_RENDERBUFFER, self.renderbuffer);
+
+        if (c_glad.glCheckFramebufferStatus(c_glad.GL_FRAMEBUFFER) != c_glad.GL_FRAMEBUFFER_COMPLETE) {
+            std.log.warn("Headless framebuffer is incomplete, frames are submitted but not rasterized", .{});
+        }
+    }
+};
+
+pub const HeadlessError = error{
+    EglInitFailed,
+    GlLoadFailed,
+};
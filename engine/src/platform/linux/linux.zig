@@ -3,15 +3,26 @@ const Platform = @import("../../utils/platform.zig");
 
 pub const Linux = struct {
     pub fn initWindow(width: i32, height: i32, window_title: [*:0]const u8) anyerror!*Window {
-        if (Platform.detectRenderer() == .wayland) return initWl(width, height, window_title);
-
-        return initX11();
+        return switch (Platform.detectRenderer()) {
+            .wayland => initWl(width, height, window_title),
+            .headless => initHeadless(width, height, window_title),
+            .null => initNull(width, height, window_title),
+            else => initX11(),
+        };
     }
 
     fn initWl(width: i32, height: i32, window_title: [*:0]const u8) anyerror!*Window {
         return @import("wayland.zig").Wayland.initWindow(width, height, window_title);
     }
 
+    fn initHeadless(width: i32, height: i32, window_title: [*:0]const u8) anyerror!*Window {
+        return @import("headless.zig").Headless.initWindow(width, height, window_title);
+    }
+
+    fn initNull(width: i32, height: i32, window_title: [*:0]const u8) anyerror!*Window {
+        return @import("../null.zig").NullPlatform.initWindow(width, height, window_title);
+    }
+
     fn initX11() anyerror!*Window {
         return @import("x11.zig").X11.initWindow();
     }
@@ -58,6 +58,12 @@ pub const Wayland = struct {
     win_title: [*:0]const u8 = "My Game",
 
     frame_callback: ?*c.wl_callback = null,
+
+    // Frame callbacks stop while renderer is idle, see `Window.is_idle`. Other threads wake this one through `wake_fd`,
+    // input and configure events only flag `is_resume_pending` since they arrive in the middle of dispatching.
+    wake_fd: std.posix.fd_t = -1,
+    is_paused: bool = false,
+    is_resume_pending: bool = false,
     program: c.GLuint = 0,
 
     last_frame_time: f32,
@@ -114,13 +120,25 @@ pub const Wayland = struct {
         const delta: f32 = time - self.last_frame_time;
         self.last_frame_time = time;
 
-        self.app.event_system.dispatchEventOnMainThread(.{ .Update = delta });
+        // Input events were queued by listeners on this thread, hand them over before the input phase drains them
+        self.app.event_system.flushQueuedEvents();
+
+        const frame_delta = self.app.event_system.beginFrame(delta);
         self.frame_event_dispatcher.dispatch({}) catch {
             std.log.err("Failed to dispatch frame event", .{});
             unreachable;
         };
         self.app.input_system.beginFrame() catch {};
-        self.app.event_system.dispatchEventOnMainThread(.{ .PostRender = delta });
+        self.app.event_system.endFrame(frame_delta);
+
+        // Nothing new to show, wait for a change instead of the compositor. Without wake fd nothing could resume frames.
+        if (self.window) |window| {
+            if (window.is_idle.load(.seq_cst) and self.wake_fd >= 0) {
+                self.frame_callback = null;
+                self.is_paused = true;
+                return;
+            }
+        }
 
         // schedule next frame callback for main surface
         self.frame_callback = c.wl_surface_frame(self.wl_surface);
@@ -136,6 +154,55 @@ pub const Wayland = struct {
         }
     }
 
+    /// Restarts frames paused while renderer was idle once current dispatch finished
+    fn queueResume(self: *Wayland) void {
+        if (self.is_paused) self.is_resume_pending = true;
+    }
+
+    /// Runs a frame right away if one was queued by `queueResume()` or `wake()`, which requests frame callbacks again
+    fn resumeIfPending(self: *Wayland) void {
+        if (!self.is_resume_pending) return;
+        self.is_resume_pending = false;
+
+        if (!self.is_paused) return;
+        self.is_paused = false;
+
+        // Paused time is not frame time, update handlers would otherwise get the whole pause as one delta
+        self.last_frame_time = @as(f32, @floatFromInt(std.time.milliTimestamp())) / 1000.0;
+        frameDone(self, null, 0);
+    }
+
+    /// `Window.on_wake`, called from any thread
+    fn wake(data: ?*anyopaque) void {
+        const self = Caster.castFromNullableAnyopaque(Wayland, data) catch return;
+        if (self.wake_fd < 0) return;
+
+        const value: u64 = 1;
+        _ = std.posix.write(self.wake_fd, std.mem.asBytes(&value)) catch {};
+    }
+
+    /// Blocks until compositor sent something or another thread called `wake()`.
+    /// Call between `wl_display_prepare_read()` and reading or cancelling.
+    ///
+    /// # Returns
+    /// Whether there are compositor events to read
+    fn waitForEvents(self: *Wayland) bool {
+        var fds = [_]std.posix.pollfd{
+            .{ .fd = c.wl_display_get_fd(self.display), .events = std.posix.POLL.IN, .revents = 0 },
+            .{ .fd = self.wake_fd, .events = std.posix.POLL.IN, .revents = 0 }, // Ignored by poll while it is -1
+        };
+
+        _ = std.posix.poll(&fds, -1) catch return true;
+
+        if (fds[1].revents & std.posix.POLL.IN != 0) {
+            var value: u64 = 0;
+            _ = std.posix.read(self.wake_fd, std.mem.asBytes(&value)) catch {};
+            self.is_resume_pending = true;
+        }
+
+        return fds[0].revents & std.posix.POLL.IN != 0;
+    }
+
     fn initListeners(self: *Wayland) void {
         const callbacks = struct {
             fn xdgWmBasePing(_: ?*anyopaque, shell: ?*c.struct_xdg_wm_base, serial: u32) callconv(.c) void {
@@ -161,9 +228,14 @@ pub const Wayland = struct {
 
                 if (inner_self.egl_window != null)
                     c.wl_egl_window_resize(inner_self.egl_window, inner_self.win_width, inner_self.win_height, 0, 0);
+
+                inner_self.queueResume();
             }
 
-            fn xdgToplevelClose(_: ?*anyopaque, _: ?*c.struct_xdg_toplevel) callconv(.c) void {
+            fn xdgToplevelClose(data: ?*anyopaque, _: ?*c.struct_xdg_toplevel) callconv(.c) void {
+                const inner_self: *Wayland = @ptrCast(@alignCast(data));
+                inner_self.app.event_system.shutdown();
+
                 std.debug.print("xdgToplevelClose: exiting\n", .{});
                 std.process.exit(0);
             }
@@ -182,11 +254,15 @@ pub const Wayland = struct {
                             const pressed = state == c.WL_KEYBOARD_KEY_STATE_PRESSED;
                             const mapped = keyCodeFromInt(key);
 
+                            // Input system is updated when the event is drained in the input phase
                             if (pressed) {
-                                inner_inner_self.app.input_system.registerKey(mapped);
+                                inner_inner_self.app.event_system.queueEvent(.{ .KeyDown = mapped });
                             } else {
-                                inner_inner_self.app.input_system.unregisterKey(mapped);
+                                inner_inner_self.app.event_system.queueEvent(.{ .KeyUp = mapped });
                             }
+
+                            // Paused frames would leave the event queued until something else changes
+                            inner_inner_self.queueResume();
                         }
 
                         fn keyboardModifiers(_: ?*anyopaque, _: ?*c.struct_wl_keyboard, _: u32, _: u32, _: u32, _: u32, _: u32) callconv(.c) void {}
@@ -378,11 +454,17 @@ pub const Wayland = struct {
 
         while (true) {
             _ = c.wl_display_dispatch_pending(wl.display);
+            wl.resumeIfPending();
             _ = c.wl_display_flush(wl.display);
 
             if (c.wl_display_prepare_read(wl.display) == 0) {
                 _ = c.wl_display_flush(wl.display);
-                _ = c.wl_display_read_events(wl.display);
+
+                if (wl.waitForEvents()) {
+                    _ = c.wl_display_read_events(wl.display);
+                } else {
+                    c.wl_display_cancel_read(wl.display);
+                }
             } else {
                 _ = c.wl_display_dispatch_pending(wl.display);
             }
@@ -407,6 +489,11 @@ pub const Wayland = struct {
             .last_frame_time = 0,
         };
 
+        wl.wake_fd = std.posix.eventfd(0, std.os.linux.EFD.CLOEXEC | std.os.linux.EFD.NONBLOCK) catch |e| blk: {
+            std.log.warn("Could not create wake fd, frames are never paused while idle: {}", .{e});
+            break :blk -1;
+        };
+
         const Result = struct {
             gl: ?*Gl,
             allocator: *std.heap.ArenaAllocator,
@@ -432,6 +519,18 @@ pub const Wayland = struct {
                         _ = c_glad.gladLoadEGL(self.egl_display, c.eglGetProcAddress);
                     }
                     fn destroy(_: *GlContext) void {}
+                    fn makeCurrent(ctx: *GlContext) anyerror!void {
+                        const self = try Caster.castFromNullableAnyopaque(Wayland, ctx.data);
+
+                        if (c.eglMakeCurrent(self.egl_display, self.egl_surface, self.egl_surface, self.egl_context) == 0) {
+                            std.debug.print("eglMakeCurrent FAILED: 0x{x}\n", .{c.eglGetError()});
+                            return error.MakeCurrentFailed;
+                        }
+                    }
+                    fn releaseCurrent(ctx: *GlContext) void {
+                        const self = Caster.castFromNullableAnyopaque(Wayland, ctx.data) catch return;
+                        _ = c.eglMakeCurrent(self.egl_display, c.EGL_NO_SURFACE, c.EGL_NO_SURFACE, c.EGL_NO_CONTEXT);
+                    }
                 };
 
                 const res = try Caster.castFromNullableAnyopaque(Result, data);
@@ -442,6 +541,8 @@ pub const Wayland = struct {
                     .destroy = fns.destroy,
                     .swap_buffers = fns.swapBuffers,
                     .load_glad = fns.loadGlad,
+                    .make_current = fns.makeCurrent,
+                    .release_current = fns.releaseCurrent,
                     .data = wayland,
                 };
 
@@ -473,6 +574,9 @@ pub const Wayland = struct {
             .on_request_frame = frame_event_dispatcher,
             .height = wl.win_height,
             .width = wl.win_width,
+            .on_wake = if (wl.wake_fd >= 0) wake else null,
+            .wake_data = wl,
+            .can_skip_frames = false, // Frame callback of a commit without new buffer may never come
         };
         wl.window = window;
         try wl.gl_initialization_complete_event_dispatcher.removeHandlerById(handler_id);
@@ -0,0 +1,130 @@
+const std = @import("std");
+
+const Event = @import("../event-system/event_dispatcher.zig").EventDispatcher;
+const GlContext = @import("../renderer/gl/gl-context.zig").GlContext;
+const Gl = @import("../renderer/gl/gl.zig").Gl;
+const gl_state_module = @import("../renderer/gl/gl-state.zig");
+const GlState = gl_state_module.GlState;
+const GlStateStats = gl_state_module.GlStateStats;
+const Window = @import("../renderer/window.zig").Window;
+const Caster = @import("../utils/caster.zig");
+const FrameLoop = @import("frame-loop.zig").FrameLoop;
+
+/// Platform without any GL context, for measuring scene, update and event cost alone.
+/// GL state is put into null mode (see `GlState.enableNullMode()`), so the renderer runs its whole frame
+/// and records state changes, draws and vertices it would have submitted, but nothing reaches a driver.
+///
+/// Environment:
+/// - `GLAZE_NULL_FPS`: Frames per second, 0 (default) runs as fast as possible
+/// - `GLAZE_NULL_FRAMES`: Exits after this many frames and prints submission totals
+pub const NullPlatform = struct {
+    frame_event_dispatcher: *Event(void, *anyopaque),
+    frame_loop: FrameLoop,
+
+    totals: GlStateStats = .{}, // Sum of every presented frame's submissions
+    frame_count: u64 = 0,
+
+    pub fn initWindow(width: i32, height: i32, _: [*:0]const u8) anyerror!*Window {
+        var allocator = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+
+        const frame_event_dispatcher = try Event(void, *anyopaque).create();
+
+        const null_platform = try allocator.allocator().create(NullPlatform);
+        null_platform.* = NullPlatform{
+            .frame_event_dispatcher = frame_event_dispatcher,
+            .frame_loop = FrameLoop.init(frame_event_dispatcher, "Null renderer", "GLAZE_NULL", 0),
+        };
+        null_platform.frame_loop.on_finished = printTotals;
+        null_platform.frame_loop.on_finished_data = null_platform;
+
+        // Loading GL only switches state cache into null mode, so it is safe on this thread
+        const gl = try null_platform.createGl();
+
+        const window = try allocator.allocator().create(Window);
+        window.* = Window{
+            .gl = gl,
+            .on_request_frame = frame_event_dispatcher,
+            .width = width,
+            .height = height,
+        };
+
+        _ = try std.Thread.spawn(.{}, run, .{null_platform});
+        return window;
+    }
+
+    /// Submissions recorded over every frame so far
+    pub fn getTotals(self: *const NullPlatform) GlStateStats {
+        return self.totals;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn run(self: *NullPlatform) void {
+        self.frame_loop.run();
+    }
+
+    fn createGl(self: *NullPlatform) !*Gl {
+        const fns = struct {
+            // Renderer resets state stats at the start of every frame, so here they hold exactly this frame
+            fn swapBuffers(ctx: *GlContext) anyerror!void {
+                const inner_self = try Caster.castFromNullableAnyopaque(NullPlatform, ctx.data);
+                const stats = GlState.get().getStats();
+
+                inner_self.totals.issued_calls += stats.issued_calls;
+                inner_self.totals.skipped_calls += stats.skipped_calls;
+                inner_self.totals.draw_calls += stats.draw_calls;
+                inner_self.totals.vertices += stats.vertices;
+                inner_self.totals.texture_binds += stats.texture_binds;
+                inner_self.frame_count += 1;
+            }
+
+            fn loadGlad(_: *GlContext) anyerror!void {
+                GlState.get().enableNullMode();
+            }
+
+            fn destroy(_: *GlContext) void {}
+
+            fn makeCurrent(_: *GlContext) anyerror!void {}
+
+            fn releaseCurrent(_: *GlContext) void {}
+        };
+
+        const page_allocator = std.heap.page_allocator;
+
+        const context = try page_allocator.create(GlContext);
+        context.* = GlContext{
+            .destroy = fns.destroy,
+            .swap_buffers = fns.swapBuffers,
+            .load_glad = fns.loadGlad,
+            .make_current = fns.makeCurrent,
+            .release_current = fns.releaseCurrent,
+            .data = self,
+        };
+
+        const gl = try page_allocator.create(Gl);
+        gl.* = try Gl.init(context);
+
+        return gl;
+    }
+
+    fn printTotals(data: ?*anyopaque, _: u64, elapsed_ns: u64) void {
+        const self = Caster.castFromNullableAnyopaque(NullPlatform, data) catch return;
+        const frames = @max(self.frame_count, 1);
+
+        std.debug.print(
+            \\Null renderer submissions over {} frames ({d:.3} ms per frame):
+            \\  draw calls:    {} ({} per frame)
+            \\  vertices:      {} ({} per frame)
+            \\  state changes: {} issued, {} skipped
+            \\
+        , .{
+            self.frame_count,
+            @as(f64, @floatFromInt(elapsed_ns)) / std.time.ns_per_ms / @as(f64, @floatFromInt(frames)),
+            self.totals.draw_calls,
+            self.totals.draw_calls / frames,
+            self.totals.vertices,
+            self.totals.vertices / frames,
+            self.totals.issued_calls,
+            self.totals.skipped_calls,
+        });
+    }
+};
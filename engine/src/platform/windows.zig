@@ -6,6 +6,7 @@ const c = @cImport({
 });
 
 const caster = @import("../utils/caster.zig");
+const Platform = @import("../utils/platform.zig");
 const key_code = @import("../input-system/keycode/keycode.zig");
 const event_manager = @import("../event-system/event_manager.zig");
 const window_state = @import("../event-system/models/window_state.zig");
@@ -36,6 +37,7 @@ pub const Windows = struct {
 
     hwnd: HWND,
     hdc: c.HDC,
+    hglrc: c.HGLRC, // Kept so render thread can make context current on itself
 
     on_request_frame: *EventDispatcher(void, *anyopaque),
 
@@ -74,11 +76,18 @@ pub const Windows = struct {
             .app = App.get(),
             .hwnd = hwnd,
             .hdc = hdc,
+            .hglrc = c.wglGetCurrentContext(),
             .on_request_frame = on_request_frame,
         };
     }
 
     pub fn initWindow(width: i32, height: i32, window_title: [*:0]const u8) anyerror!*Window {
+        switch (Platform.detectRenderer()) {
+            .null => return @import("null.zig").NullPlatform.initWindow(width, height, window_title),
+            .win32 => {},
+            else => |renderer| std.log.warn("{s} renderer is not available on Windows, using win32", .{@tagName(renderer)}),
+        }
+
         // Create result instance that will be populated with data after windows thread is finished loading
         const result: *Result = try cAlloc(Result);
         result.* = Result{
@@ -122,11 +131,11 @@ pub const Windows = struct {
             const delta_ms = timer.deltaMilliseconds() / 1000.0;
             elapsed_time += delta_ms;
 
-            self.app.event_system.render_events.on_update.dispatch(delta_ms) catch |e| {
-                std.log.err("Error rendering events: {}", .{e});
-            };
+            // Hand over everything the message handler queued, input phase of this frame will dispatch it
+            self.app.event_system.flushQueuedEvents();
 
-            //self.app.event_system.dispatchEventOnMainThread(.{ .Update = delta_ms });
+            // Goes through event manager so recording and replay see every frame
+            const frame_delta = self.app.event_system.beginFrame(delta_ms);
 
             // -------- Rendering --------
             self.on_request_frame.dispatch({}) catch |e| {
@@ -134,7 +143,7 @@ pub const Windows = struct {
             };
 
             // -------- Post Render --------
-            self.app.event_system.dispatchEventOnEventThread(.{ .PostRender = delta_ms });
+            self.app.event_system.endFrame(frame_delta);
         }
     }
 
@@ -143,8 +152,9 @@ pub const Windows = struct {
 
         switch (uMsg) {
             c.WM_DESTROY => {
-                // Fire events
+                // Process exits right away so this can not wait for the next frame's input phase
                 app.event_system.dispatchEventOnEventThread(.{ .WindowDestroy = {} });
+                app.event_system.shutdown();
 
                 c.PostQuitMessage(0);
 
@@ -152,8 +162,9 @@ pub const Windows = struct {
             },
 
             c.WM_CLOSE => {
-                // Fire events
+                // Process exits right away so this can not wait for the next frame's input phase
                 app.event_system.dispatchEventOnEventThread(.{ .WindowClose = {} });
+                app.event_system.shutdown();
 
                 c.PostQuitMessage(0);
 
@@ -163,8 +174,7 @@ pub const Windows = struct {
             c.WM_KEYDOWN => {
                 // Fire events
                 const key: key_code.KeyCode = key_code.keycodeFromInt(@intCast(wParam));
-                app.input_system.registerKey(key);
-                app.event_system.dispatchEventOnEventThread(.{ .KeyDown = key });
+                app.event_system.queueEvent(.{ .KeyDown = key });
 
                 return 0;
             },
@@ -172,8 +182,7 @@ pub const Windows = struct {
             c.WM_KEYUP => {
                 // Fire events
                 const key: key_code.KeyCode = key_code.keycodeFromInt(@intCast(wParam));
-                app.input_system.unregisterKey(key);
-                app.event_system.dispatchEventOnEventThread(.{ .KeyUp = key });
+                app.event_system.queueEvent(.{ .KeyUp = key });
 
                 return 0;
             },
@@ -188,26 +197,26 @@ pub const Windows = struct {
                 app.renderer.window.width = @intCast(size.width);
                 app.renderer.window.height = @intCast(size.height);
 
-                app.event_system.dispatchEventOnEventThread(.{ .WindowResize = size });
+                app.event_system.queueEvent(.{ .WindowResize = size });
 
                 return 0;
             },
 
             c.WM_MOUSEMOVE => {
                 const position: MousePosition = MousePosition.init(@intCast(lParam & 0xFFFF), @intCast((lParam >> 16) & 0xFFFF));
-                app.event_system.dispatchEventOnEventThread(.{ .MouseMove = position });
+                app.event_system.queueEvent(.{ .MouseMove = position });
 
                 return 0;
             },
 
             c.WM_SETFOCUS => {
-                app.event_system.dispatchEventOnEventThread(.{ .WindowFocusGain = {} });
+                app.event_system.queueEvent(.{ .WindowFocusGain = {} });
 
                 return 0;
             },
 
             c.WM_KILLFOCUS => {
-                app.event_system.dispatchEventOnEventThread(.{ .WindowFocusLose = {} });
+                app.event_system.queueEvent(.{ .WindowFocusLose = {} });
 
                 return 0;
             },
@@ -277,6 +286,8 @@ pub const Windows = struct {
             .swap_buffers = glContextswapBufferWrap,
             .load_glad = glContextloadGladWrap,
             .destroy = glContextDestroyWrap,
+            .make_current = glContextMakeCurrentWrap,
+            .release_current = glContextReleaseCurrentWrap,
             .data = windows,
         };
 
@@ -307,6 +318,16 @@ pub const Windows = struct {
 
     fn glContextDestroyWrap(_: *GLContext) void {}
 
+    fn glContextMakeCurrentWrap(self: *GLContext) anyerror!void {
+        const windows: *Windows = try caster.castFromNullableAnyopaque(Windows, self.data);
+
+        if (c.wglMakeCurrent(windows.hdc, windows.hglrc) == 0) return error.MakeCurrentFailed;
+    }
+
+    fn glContextReleaseCurrentWrap(_: *GLContext) void {
+        _ = c.wglMakeCurrent(null, null);
+    }
+
     fn loadGLProc(name: [*c]const u8) callconv(.c) ?*const fn () callconv(.c) void {
         const addr = c.wglGetProcAddress(name);
         if (addr != null) return @ptrCast(addr);
@@ -0,0 +1,81 @@
+const std = @import("std");
+
+const MaterialInstance = @import("../materials/material-instance.zig").MaterialInstance;
+const TextureHandle = @import("../textures/texture-manager.zig").TextureHandle;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Sprite as recorded by the build stage, everything the render thread needs without touching the scene
+pub const SpriteCommand = struct {
+    material: *MaterialInstance,
+    texture: ?TextureHandle, // Own reference, released once list was executed, sprite is drawn untextured without one
+    model_matrix: [16]f32,
+    color: [4]f32,
+    screen_size: f32, // Longest side on screen in pixels, drives texture residency
+    depth: f32,
+    layer: u8,
+};
+
+/// Camera and timing of a frame that has something to draw
+pub const FrameView = struct {
+    view_projection: [16]f32,
+    viewport: [4]f32, // x, y, width, height
+    time: f32, // Seconds since start
+    delta: f32, // Seconds since previous frame
+    scene_key: usize, // Identifies scene for sprite path selection
+    object_count: usize, // Active game objects, whether they have a sprite or not
+};
+
+/// Everything a frame draws, recorded from a scene snapshot on the frame thread and executed on the render thread.
+/// Storage is kept between frames, so recording does not allocate once list reached its working size.
+pub const CommandList = struct {
+    allocator: Allocator,
+
+    width: i32,
+    height: i32,
+    view: ?FrameView, // Null when there is no active scene or camera, frame is only cleared
+
+    culled_count: usize, // Sprites left out because they were outside of the view
+    build_ns: u64, // Time it took to record the list
+
+    sprites: ArrayList(SpriteCommand),
+
+    pub fn init(allocator: Allocator) CommandList {
+        return CommandList{
+            .allocator = allocator,
+            .width = 0,
+            .height = 0,
+            .view = null,
+            .culled_count = 0,
+            .build_ns = 0,
+            .sprites = ArrayList(SpriteCommand){},
+        };
+    }
+
+    pub fn deinit(self: *CommandList) void {
+        self.clear();
+        self.sprites.deinit(self.allocator);
+    }
+
+    /// Releases texture references held by recorded sprites and empties the list, keeping its storage
+    pub fn clear(self: *CommandList) void {
+        for (self.sprites.items) |sprite| {
+            if (sprite.texture) |handle| handle.release();
+        }
+
+        self.sprites.clearRetainingCapacity();
+        self.view = null;
+        self.culled_count = 0;
+        self.build_ns = 0;
+    }
+
+    /// Appends sprite, list takes over its texture reference
+    pub fn addSprite(self: *CommandList, sprite: SpriteCommand) !void {
+        try self.sprites.append(self.allocator, sprite);
+    }
+
+    pub fn getSprites(self: *const CommandList) []const SpriteCommand {
+        return self.sprites.items;
+    }
+};
@@ -0,0 +1,240 @@
+const std = @import("std");
+
+const getEnvOwned = @import("../utils/platform.zig").getEnvOwned;
+
+/// Frames kept by `FrameStatsHistory`, a few seconds at common refresh rates
+pub const frame_stats_history_size = 240;
+
+/// Frames summarized per dump line when `GLAZE_FRAME_STATS_INTERVAL` is not set
+const default_dump_interval = 60;
+
+/// What the renderer did during a single frame
+pub const FrameStats = struct {
+    frame_index: u64 = 0, // Counts every frame executed since start
+
+    draw_calls: u64 = 0,
+    batches: u64 = 0, // Sprite batches, or instanced draws, the sprite path split the frame into
+    vertices: u64 = 0,
+    state_changes: u64 = 0, // GL state changes that reached the driver
+    skipped_state_changes: u64 = 0, // Redundant ones dropped by state cache
+    texture_binds: u64 = 0,
+
+    sprites_drawn: u64 = 0,
+    sprites_culled: u64 = 0, // Outside of the view, never recorded by the build stage
+
+    bytes_streamed: u64 = 0, // Sprite geometry written into stream buffer
+
+    build_ns: u64 = 0, // CPU time recording the command list on the frame thread
+    submit_ns: u64 = 0, // CPU time executing it on the render thread, presenting excluded
+};
+
+/// Average and worst frame over some range of frames
+pub const FrameStatsSummary = struct {
+    frame_count: usize = 0,
+    average: FrameStats = .{},
+    peak: FrameStats = .{}, // Highest value of every field, not a single frame
+};
+
+/// Where `FrameStatsHistory` periodically writes summaries to
+pub const FrameStatsDumpTarget = union(enum) {
+    None,
+    Stdout,
+    File: []const u8, // Path, truncated when dump is enabled
+};
+
+/// Ring of the last `frame_stats_history_size` frames, written by the render thread and readable from any thread.
+/// Optionally writes a summary line every `interval` frames, see `setDump()`.
+///
+/// Environment, read by `init()`:
+/// - `GLAZE_FRAME_STATS`: `stdout` or path of a file to dump summaries to
+/// - `GLAZE_FRAME_STATS_INTERVAL`: Frames per summary, 60 by default
+pub const FrameStatsHistory = struct {
+    frames: [frame_stats_history_size]FrameStats = undefined,
+    frame_count: usize = 0, // Frames pushed so far, newest one is at `(frame_count - 1) % size`
+
+    dump_file: ?std.fs.File = null,
+    owns_dump_file: bool = false, // Stdout is not closed
+    dump_interval: usize = default_dump_interval,
+
+    mutex: std.Thread.Mutex = .{},
+
+    pub fn init() FrameStatsHistory {
+        var history = FrameStatsHistory{};
+        const allocator = std.heap.c_allocator;
+
+        // Path is only needed until dump file is created
+        const target_value = getEnvOwned(allocator, "GLAZE_FRAME_STATS");
+        defer if (target_value) |value| allocator.free(value);
+
+        const target: FrameStatsDumpTarget = if (target_value) |value|
+            if (std.mem.eql(u8, value, "stdout")) .Stdout else .{ .File = value }
+        else
+            .None;
+
+        const interval_value = getEnvOwned(allocator, "GLAZE_FRAME_STATS_INTERVAL");
+        defer if (interval_value) |value| allocator.free(value);
+
+        const interval = if (interval_value) |value|
+            std.fmt.parseInt(usize, value, 10) catch blk: {
+                std.log.warn("Ignoring GLAZE_FRAME_STATS_INTERVAL={s}, expected a whole number", .{value});
+                break :blk default_dump_interval;
+            }
+        else
+            default_dump_interval;
+
+        history.setDump(target, interval) catch |e| {
+            std.log.err("Failed to open frame stats dump: {}", .{e});
+        };
+
+        return history;
+    }
+
+    pub fn deinit(self: *FrameStatsHistory) void {
+        self.closeDump();
+    }
+
+    /// Stores stats of a finished frame, assigning its `frame_index`, and dumps a summary when the interval is up
+    pub fn push(self: *FrameStatsHistory, stats: FrameStats) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        var frame = stats;
+        frame.frame_index = self.frame_count;
+
+        self.frames[self.frame_count % frame_stats_history_size] = frame;
+        self.frame_count += 1;
+
+        if (self.dump_file != null and self.frame_count % self.dump_interval == 0) {
+            self.writeDump() catch |e| {
+                std.log.err("Failed to write frame stats, dump disabled: {}", .{e});
+                self.closeDump();
+            };
+        }
+    }
+
+    /// Stats of the most recent frame, null before the first one finished
+    pub fn getLatest(self: *FrameStatsHistory) ?FrameStats {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (self.frame_count == 0) return null;
+        return self.frames[(self.frame_count - 1) % frame_stats_history_size];
+    }
+
+    /// Copies up to `buffer.len` most recent frames into `buffer`, oldest first
+    ///
+    /// # Returns
+    /// Part of `buffer` that was filled
+    pub fn copyRecent(self: *FrameStatsHistory, buffer: []FrameStats) []FrameStats {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const count = @min(buffer.len, self.getStoredCount());
+        const first = self.frame_count - count;
+
+        for (buffer[0..count], 0..) |*frame, i| {
+            frame.* = self.frames[(first + i) % frame_stats_history_size];
+        }
+
+        return buffer[0..count];
+    }
+
+    /// Summarizes up to `frame_count` most recent frames
+    pub fn summarize(self: *FrameStatsHistory, frame_count: usize) FrameStatsSummary {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        return self.summarizeLocked(frame_count);
+    }
+
+    /// Starts writing a summary of the last `interval` frames every `interval` frames, replacing previous target.
+    /// `interval` is clamped to at least one frame.
+    ///
+    /// # Errors
+    /// - Whatever `std.fs.Dir.createFile()` returns for `File` targets, dump stays disabled
+    pub fn setDump(self: *FrameStatsHistory, target: FrameStatsDumpTarget, interval: usize) !void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.closeDump();
+        self.dump_interval = @max(interval, 1);
+
+        switch (target) {
+            .None => {},
+            .Stdout => self.dump_file = std.fs.File.stdout(),
+            .File => |path| {
+                self.dump_file = try std.fs.cwd().createFile(path, .{});
+                self.owns_dump_file = true;
+            },
+        }
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn getStoredCount(self: *const FrameStatsHistory) usize {
+        return @min(self.frame_count, frame_stats_history_size);
+    }
+
+    fn summarizeLocked(self: *const FrameStatsHistory, frame_count: usize) FrameStatsSummary {
+        const count = @min(frame_count, self.getStoredCount());
+        if (count == 0) return .{};
+
+        var summary = FrameStatsSummary{ .frame_count = count };
+        var totals = FrameStats{};
+
+        for (self.frame_count - count..self.frame_count) |index| {
+            const frame = self.frames[index % frame_stats_history_size];
+
+            inline for (std.meta.fields(FrameStats)) |field| {
+                @field(totals, field.name) += @field(frame, field.name);
+                @field(summary.peak, field.name) = @max(@field(summary.peak, field.name), @field(frame, field.name));
+            }
+        }
+
+        const divisor: u64 = count;
+        inline for (std.meta.fields(FrameStats)) |field| {
+            @field(summary.average, field.name) = @field(totals, field.name) / divisor;
+        }
+
+        // Index of a range is not an average, report the newest frame instead
+        summary.average.frame_index = summary.peak.frame_index;
+        return summary;
+    }
+
+    /// Writes a single line with average and peak of every counter over the last interval
+    fn writeDump(self: *FrameStatsHistory) !void {
+        const file = self.dump_file orelse return;
+        const summary = self.summarizeLocked(self.dump_interval);
+
+        var buffer: [1024]u8 = undefined;
+        var writer = std.Io.Writer.fixed(&buffer);
+
+        const last_frame = summary.peak.frame_index;
+        try writer.print("frames {}-{}:", .{ last_frame + 1 - @as(u64, summary.frame_count), last_frame });
+
+        inline for (std.meta.fields(FrameStats)) |field| {
+            if (comptime std.mem.eql(u8, field.name, "frame_index")) continue;
+
+            const average = @field(summary.average, field.name);
+            const peak = @field(summary.peak, field.name);
+
+            if (comptime std.mem.endsWith(u8, field.name, "_ns")) {
+                const ns_per_ms: f64 = std.time.ns_per_ms;
+                try writer.print(" {s}_ms={d:.3}/{d:.3}", .{ field.name[0 .. field.name.len - 3], @as(f64, @floatFromInt(average)) / ns_per_ms, @as(f64, @floatFromInt(peak)) / ns_per_ms });
+            } else {
+                try writer.print(" {s}={}/{}", .{ field.name, average, peak });
+            }
+        }
+
+        try writer.writeByte('\n');
+        try file.writeAll(writer.buffered());
+    }
+
+    fn closeDump(self: *FrameStatsHistory) void {
+        if (self.owns_dump_file) {
+            if (self.dump_file) |file| file.close();
+        }
+
+        self.dump_file = null;
+        self.owns_dump_file = false;
+    }
+};
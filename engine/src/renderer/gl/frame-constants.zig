@@ -0,0 +1,139 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const GlState = @import("gl-state.zig").GlState;
+
+/// Uniform buffer binding point every material's `FrameConstants` block is attached to
+pub const binding_point = 0;
+pub const block_name = "FrameConstants";
+
+/// Declarations injected right after `#version` of every material shader when uniform buffers are available
+pub const block_prelude =
+    \\layout(std140) uniform FrameConstants {
+    \\    mat4 u_ViewProjection;
+    \\    vec4 u_Viewport; // x, y, width, height
+    \\    vec4 u_Time; // seconds since start, delta, frame index, unused
+    \\};
+    \\
+;
+
+/// Same declarations as plain uniforms for contexts without uniform buffers
+pub const uniform_prelude =
+    \\uniform mat4 u_ViewProjection;
+    \\uniform vec4 u_Viewport;
+    \\uniform vec4 u_Time;
+    \\
+;
+
+/// Whether current GL context has uniform buffers. Only valid after GL was loaded.
+pub fn isBlockSupported() bool {
+    return c.GLAD_GL_VERSION_3_1 != 0;
+}
+
+pub fn getPrelude() [:0]const u8 {
+    return if (isBlockSupported()) block_prelude else uniform_prelude;
+}
+
+/// Layout of `FrameConstants` block, std140
+pub const FrameConstants = extern struct {
+    view_projection: [16]f32,
+    viewport: [4]f32,
+    time: [4]f32,
+};
+
+/// Uniform locations of frame constants in a program that uses plain uniforms
+pub const FrameUniformLocations = struct {
+    view_projection: i32,
+    viewport: i32,
+    time: i32,
+
+    /// Frame whose constants were last uploaded into the program
+    uploaded_version: u64 = 0,
+
+    /// Locations of a program that uses none of the constants, e.g. one created without a GL context
+    pub const none = FrameUniformLocations{ .view_projection = -1, .viewport = -1, .time = -1 };
+
+    /// Looks up uniforms, or attaches the uniform block to `binding_point` when blocks are supported
+    pub fn init(program: c.GLuint) FrameUniformLocations {
+        if (isBlockSupported()) {
+            const block_index = c.glGetUniformBlockIndex(program, block_name);
+            if (block_index != c.GL_INVALID_INDEX) c.glUniformBlockBinding(program, block_index, binding_point);
+
+            return none;
+        }
+
+        return FrameUniformLocations{
+            .view_projection = c.glGetUniformLocation(program, "u_ViewProjection"),
+            .viewport = c.glGetUniformLocation(program, "u_Viewport"),
+            .time = c.glGetUniformLocation(program, "u_Time"),
+        };
+    }
+};
+
+/// Per frame constants shared by every material. Uploaded once per frame into a uniform buffer,
+/// or, without uniform buffers, once per program per frame the first time the program is used.
+pub const FrameConstantsBuffer = struct {
+    constants: FrameConstants,
+    version: u64,
+
+    ubo_handle: c.GLuint,
+    is_ubo_initialized: bool,
+
+    pub fn init() FrameConstantsBuffer {
+        return FrameConstantsBuffer{
+            .constants = std.mem.zeroes(FrameConstants),
+            .version = 0,
+            .ubo_handle = 0,
+            .is_ubo_initialized = false,
+        };
+    }
+
+    pub fn deinit(self: *FrameConstantsBuffer) void {
+        if (self.is_ubo_initialized) c.glDeleteBuffers(1, &self.ubo_handle);
+    }
+
+    /// Sets constants for the frame about to be drawn
+    ///
+    /// # Arguments
+    /// - `view_projection`: Combined projection * view matrix
+    /// - `viewport`: x, y, width and height in pixels
+    /// - `time`: Seconds since start
+    /// - `delta`: Seconds since previous frame
+    pub fn update(self: *FrameConstantsBuffer, view_projection: *const [16]f32, viewport: [4]f32, time: f32, delta: f32) void {
+        self.version += 1;
+        self.constants = FrameConstants{
+            .view_projection = view_projection.*,
+            .viewport = viewport,
+            .time = .{ time, delta, @floatFromInt(self.version), 0.0 },
+        };
+
+        if (!isBlockSupported() or GlState.get().isNull()) return;
+
+        if (!self.is_ubo_initialized) {
+            c.glGenBuffers(1, &self.ubo_handle);
+            c.glBindBuffer(c.GL_UNIFORM_BUFFER, self.ubo_handle);
+            c.glBufferData(c.GL_UNIFORM_BUFFER, @sizeOf(FrameConstants), null, c.GL_DYNAMIC_DRAW);
+            c.glBindBufferBase(c.GL_UNIFORM_BUFFER, binding_point, self.ubo_handle);
+            self.is_ubo_initialized = true;
+        }
+
+        c.glBindBuffer(c.GL_UNIFORM_BUFFER, self.ubo_handle);
+        c.glBufferSubData(c.GL_UNIFORM_BUFFER, 0, @sizeOf(FrameConstants), &self.constants);
+    }
+
+    /// Makes sure program that was just bound sees this frame's constants.
+    /// Does nothing with uniform buffers, otherwise uploads uniforms once per frame per program.
+    pub fn apply(self: *FrameConstantsBuffer, locations: *FrameUniformLocations) void {
+        if (locations.uploaded_version == self.version) return;
+        locations.uploaded_version = self.version;
+
+        if (isBlockSupported() or GlState.get().isNull()) return;
+
+        c.glUniformMatrix4fv(locations.view_projection, 1, c.GL_FALSE, &self.constants.view_projection);
+        c.glUniform4fv(locations.viewport, 1, &self.constants.viewport);
+        c.glUniform4fv(locations.time, 1, &self.constants.time);
+    }
+};
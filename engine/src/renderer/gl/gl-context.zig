@@ -3,5 +3,9 @@ pub const GlContext = struct {
     load_glad: *const fn (*GlContext) anyerror!void,
     destroy: *const fn (*GlContext) void,
 
+    // Context is created current on the platform thread, `RenderThread` moves it over to itself
+    make_current: *const fn (*GlContext) anyerror!void, // Binds context to calling thread
+    release_current: *const fn (*GlContext) void, // Unbinds context from calling thread, so another one can bind it
+
     data: *anyopaque,
 };
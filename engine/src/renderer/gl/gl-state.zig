@@ -0,0 +1,370 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const max_texture_units = 16;
+const max_vertex_attributes = 16;
+
+/// Layout of a single vertex attribute, offset is relative to the bound array buffer
+pub const VertexAttribute = struct {
+    size: c.GLint,
+    kind: c.GLenum = c.GL_FLOAT,
+    normalized: bool = false,
+    stride: c.GLsizei,
+    offset: usize,
+};
+
+const AttributeBinding = struct {
+    buffer: c.GLuint,
+    attribute: VertexAttribute,
+};
+
+/// Number of state changes that reached the driver and that were skipped since last `resetStats()`,
+/// together with the draws submitted
+pub const GlStateStats = struct {
+    issued_calls: u64 = 0,
+    skipped_calls: u64 = 0,
+    draw_calls: u64 = 0,
+    vertices: u64 = 0, // Vertices processed by draws, instanced draws count every instance
+    texture_binds: u64 = 0, // Issued texture binds, also counted in `issued_calls`
+};
+
+var instance: GlState = .{};
+
+/// Shadow copy of GL state that skips calls which would not change anything.
+/// There is a single instance per GL context, everything that binds GL state has to go through it,
+/// otherwise the shadow goes stale. Call `invalidate()` after touching GL state directly.
+/// Unknown state is `null`, so the first call after `invalidate()` always reaches the driver.
+///
+/// In null mode (see `enableNullMode()`) the shadow and stats are kept but no call reaches GL,
+/// which lets the renderer run its whole frame without a context.
+pub const GlState = struct {
+    program: ?c.GLuint = null,
+    array_buffer: ?c.GLuint = null,
+    element_array_buffer: ?c.GLuint = null,
+
+    active_texture_unit: ?u32 = null,
+    texture_bindings: [max_texture_units]?c.GLuint = .{null} ** max_texture_units,
+
+    blend_enabled: ?bool = null,
+    blend_func: ?[2]c.GLenum = null,
+    viewport: ?[4]c.GLint = null,
+
+    attribute_enabled: [max_vertex_attributes]?bool = .{null} ** max_vertex_attributes,
+    attribute_bindings: [max_vertex_attributes]?AttributeBinding = .{null} ** max_vertex_attributes,
+    attribute_divisors: [max_vertex_attributes]?c.GLuint = .{null} ** max_vertex_attributes,
+
+    stats: GlStateStats = .{},
+
+    is_null: bool = false,
+    next_null_name: c.GLuint = 0,
+
+    /// State of the current GL context, must only be used on the thread that owns it
+    pub fn get() *GlState {
+        return &instance;
+    }
+
+    /// Forgets everything shadowed, e.g. after context was recreated
+    pub fn invalidate(self: *GlState) void {
+        const stats = self.stats;
+        const is_null = self.is_null;
+        const next_null_name = self.next_null_name;
+
+        self.* = GlState{};
+        self.stats = stats;
+        self.is_null = is_null;
+        self.next_null_name = next_null_name;
+    }
+
+    /// Stops every call from reaching GL, state changes and draws are only recorded. Used by `NullPlatform`.
+    pub fn enableNullMode(self: *GlState) void {
+        self.invalidate();
+        self.is_null = true;
+    }
+
+    pub fn isNull(self: *const GlState) bool {
+        return self.is_null;
+    }
+
+    /// Unique non zero name standing in for a GL object in null mode
+    pub fn createNullName(self: *GlState) c.GLuint {
+        self.next_null_name += 1;
+        return self.next_null_name;
+    }
+
+    //#region Frame
+    pub fn clear(self: *GlState, r: f32, g: f32, b: f32, a: f32) void {
+        if (self.is_null) return;
+
+        c.glClearColor(r, g, b, a);
+        c.glClear(c.GL_COLOR_BUFFER_BIT);
+    }
+    //#endregion
+
+    //#region Programs and buffers
+    /// # Returns
+    /// - `true` if program changed
+    pub fn useProgram(self: *GlState, program: c.GLuint) bool {
+        if (isKnown(c.GLuint, self.program, program)) return self.skip();
+
+        if (!self.is_null) c.glUseProgram(program);
+        self.program = program;
+        return self.issue();
+    }
+
+    pub fn bindArrayBuffer(self: *GlState, buffer: c.GLuint) void {
+        if (isKnown(c.GLuint, self.array_buffer, buffer)) {
+            _ = self.skip();
+            return;
+        }
+
+        if (!self.is_null) c.glBindBuffer(c.GL_ARRAY_BUFFER, buffer);
+        self.array_buffer = buffer;
+        _ = self.issue();
+    }
+
+    pub fn bindElementArrayBuffer(self: *GlState, buffer: c.GLuint) void {
+        if (isKnown(c.GLuint, self.element_array_buffer, buffer)) {
+            _ = self.skip();
+            return;
+        }
+
+        if (!self.is_null) c.glBindBuffer(c.GL_ELEMENT_ARRAY_BUFFER, buffer);
+        self.element_array_buffer = buffer;
+        _ = self.issue();
+    }
+
+    pub fn createBuffer(self: *GlState) c.GLuint {
+        if (self.is_null) return self.createNullName();
+
+        var buffer: c.GLuint = 0;
+        c.glGenBuffers(1, &buffer);
+        return buffer;
+    }
+
+    /// Replaces storage of buffer bound to `target` with `bytes`
+    pub fn bufferData(self: *GlState, target: c.GLenum, bytes: []const u8, usage: c.GLenum) void {
+        if (self.is_null) return;
+
+        c.glBufferData(target, @intCast(bytes.len), bytes.ptr, usage);
+    }
+
+    /// Deletes buffer and clears any shadowed binding of it, GL rebinds deleted buffers to 0
+    pub fn deleteBuffer(self: *GlState, buffer: c.GLuint) void {
+        var handle = buffer;
+        if (!self.is_null) c.glDeleteBuffers(1, &handle);
+
+        if (isKnown(c.GLuint, self.array_buffer, buffer)) self.array_buffer = 0;
+        if (isKnown(c.GLuint, self.element_array_buffer, buffer)) self.element_array_buffer = 0;
+
+        // GL hands out deleted names again, a new buffer with the same name must not match a stale pointer
+        for (&self.attribute_bindings) |*binding| {
+            if (binding.*) |current| {
+                if (current.buffer == buffer) binding.* = null;
+            }
+        }
+    }
+    //#endregion
+
+    //#region Textures
+    /// Binds 2D texture to texture unit
+    pub fn bindTexture2D(self: *GlState, unit: u32, texture: c.GLuint) void {
+        std.debug.assert(unit < max_texture_units);
+
+        if (isKnown(c.GLuint, self.texture_bindings[unit], texture)) {
+            _ = self.skip();
+            return;
+        }
+
+        self.activeTexture(unit);
+        if (!self.is_null) c.glBindTexture(c.GL_TEXTURE_2D, texture);
+        self.texture_bindings[unit] = texture;
+        self.stats.texture_binds += 1;
+        _ = self.issue();
+    }
+
+    /// Deletes texture and clears every shadowed binding of it
+    pub fn deleteTexture(self: *GlState, texture: c.GLuint) void {
+        var handle = texture;
+        if (!self.is_null) c.glDeleteTextures(1, &handle);
+
+        for (&self.texture_bindings) |*binding| {
+            if (isKnown(c.GLuint, binding.*, texture)) binding.* = 0;
+        }
+    }
+    //#endregion
+
+    //#region Fixed function state
+    pub fn setBlend(self: *GlState, enabled: bool) void {
+        if (isKnown(bool, self.blend_enabled, enabled)) {
+            _ = self.skip();
+            return;
+        }
+
+        if (!self.is_null) {
+            if (enabled) c.glEnable(c.GL_BLEND) else c.glDisable(c.GL_BLEND);
+        }
+        self.blend_enabled = enabled;
+        _ = self.issue();
+    }
+
+    pub fn setBlendFunc(self: *GlState, source: c.GLenum, destination: c.GLenum) void {
+        if (self.blend_func) |current| {
+            if (current[0] == source and current[1] == destination) {
+                _ = self.skip();
+                return;
+            }
+        }
+
+        if (!self.is_null) c.glBlendFunc(source, destination);
+        self.blend_func = .{ source, destination };
+        _ = self.issue();
+    }
+
+    pub fn setViewport(self: *GlState, x: c.GLint, y: c.GLint, width: c.GLint, height: c.GLint) void {
+        const viewport = [4]c.GLint{ x, y, width, height };
+        if (self.viewport) |current| {
+            if (std.mem.eql(c.GLint, &current, &viewport)) {
+                _ = self.skip();
+                return;
+            }
+        }
+
+        if (!self.is_null) c.glViewport(x, y, width, height);
+        self.viewport = viewport;
+        _ = self.issue();
+    }
+    //#endregion
+
+    //#region Vertex attributes
+    pub fn enableAttribute(self: *GlState, location: c.GLuint) void {
+        self.setAttributeEnabled(location, true);
+    }
+
+    pub fn disableAttribute(self: *GlState, location: c.GLuint) void {
+        self.setAttributeEnabled(location, false);
+    }
+
+    /// Points attribute at currently bound array buffer
+    pub fn setAttributePointer(self: *GlState, location: c.GLuint, attribute: VertexAttribute) void {
+        std.debug.assert(location < max_vertex_attributes);
+
+        const buffer = self.array_buffer orelse blk: {
+            if (self.is_null) break :blk 0;
+
+            var bound: c.GLint = 0;
+            c.glGetIntegerv(c.GL_ARRAY_BUFFER_BINDING, &bound);
+            break :blk @as(c.GLuint, @intCast(bound));
+        };
+
+        const binding = AttributeBinding{ .buffer = buffer, .attribute = attribute };
+        if (self.attribute_bindings[location]) |current| {
+            if (std.meta.eql(current, binding)) {
+                _ = self.skip();
+                return;
+            }
+        }
+
+        if (!self.is_null) {
+            c.glVertexAttribPointer(
+                location,
+                attribute.size,
+                attribute.kind,
+                if (attribute.normalized) c.GL_TRUE else c.GL_FALSE,
+                attribute.stride,
+                @ptrFromInt(attribute.offset),
+            );
+        }
+        self.attribute_bindings[location] = binding;
+        _ = self.issue();
+    }
+
+    pub fn setAttributeDivisor(self: *GlState, location: c.GLuint, divisor: c.GLuint) void {
+        std.debug.assert(location < max_vertex_attributes);
+
+        if (isKnown(c.GLuint, self.attribute_divisors[location], divisor)) {
+            _ = self.skip();
+            return;
+        }
+
+        if (!self.is_null) c.glVertexAttribDivisor(location, divisor);
+        self.attribute_divisors[location] = divisor;
+        _ = self.issue();
+    }
+    //#endregion
+
+    //#region Draws
+    /// Draws triangles from `index_count` u32 indices of bound element array buffer
+    pub fn drawTriangles(self: *GlState, index_count: usize) void {
+        self.recordDraw(index_count);
+        if (self.is_null) return;
+
+        c.glDrawElements(c.GL_TRIANGLES, @intCast(index_count), c.GL_UNSIGNED_INT, null);
+    }
+
+    /// Draws `instance_count` instances of triangles from `index_count` u32 indices of bound element array buffer
+    pub fn drawTrianglesInstanced(self: *GlState, index_count: usize, instance_count: usize) void {
+        self.recordDraw(index_count * instance_count);
+        if (self.is_null) return;
+
+        c.glDrawElementsInstanced(c.GL_TRIANGLES, @intCast(index_count), c.GL_UNSIGNED_INT, null, @intCast(instance_count));
+    }
+    //#endregion
+
+    //#region Profiling
+    pub fn getStats(self: *const GlState) GlStateStats {
+        return self.stats;
+    }
+
+    pub fn resetStats(self: *GlState) void {
+        self.stats = .{};
+    }
+    //#endregion
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn activeTexture(self: *GlState, unit: u32) void {
+        if (isKnown(u32, self.active_texture_unit, unit)) return;
+
+        if (!self.is_null) c.glActiveTexture(c.GL_TEXTURE0 + unit);
+        self.active_texture_unit = unit;
+        _ = self.issue();
+    }
+
+    fn setAttributeEnabled(self: *GlState, location: c.GLuint, enabled: bool) void {
+        std.debug.assert(location < max_vertex_attributes);
+
+        if (isKnown(bool, self.attribute_enabled[location], enabled)) {
+            _ = self.skip();
+            return;
+        }
+
+        if (!self.is_null) {
+            if (enabled) c.glEnableVertexAttribArray(location) else c.glDisableVertexAttribArray(location);
+        }
+        self.attribute_enabled[location] = enabled;
+        _ = self.issue();
+    }
+
+    /// Whether shadowed state is known and equal to `value`
+    fn isKnown(comptime T: type, shadow: ?T, value: T) bool {
+        const current = shadow orelse return false;
+        return current == value;
+    }
+
+    fn recordDraw(self: *GlState, vertex_count: usize) void {
+        self.stats.draw_calls += 1;
+        self.stats.vertices += vertex_count;
+    }
+
+    fn issue(self: *GlState) bool {
+        self.stats.issued_calls += 1;
+        return true;
+    }
+
+    fn skip(self: *GlState) bool {
+        self.stats.skipped_calls += 1;
+        return false;
+    }
+};
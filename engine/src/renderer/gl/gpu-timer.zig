@@ -0,0 +1,89 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const GlState = @import("gl-state.zig").GlState;
+
+/// Queries in flight at once, results are read a few frames after they were issued
+const query_count = 4;
+
+/// Measures how long the GPU spends on a range of commands with `GL_TIME_ELAPSED` queries.
+/// Results are only read once the GPU made them available, so measuring never waits on it.
+/// Every measured range is labeled with a `Tag`, e.g. the sprite path it was drawn with.
+pub fn GpuTimer(comptime Tag: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const Result = struct {
+            tag: Tag,
+            ns: u64,
+        };
+
+        queries: [query_count]c.GLuint = .{0} ** query_count,
+        tags: [query_count]?Tag = .{null} ** query_count, // Set while query waits for its result
+        next: usize = 0, // Oldest query, reused by next `begin()`
+        active: ?usize = null,
+        is_initialized: bool = false,
+
+        /// Timer queries are core since GL 3.3, nothing is measured without them or in null mode
+        pub fn isSupported() bool {
+            return !GlState.get().isNull() and c.GLAD_GL_VERSION_3_3 != 0;
+        }
+
+        /// Starts measuring commands issued until `end()`. GL thread only.
+        ///
+        /// # Returns
+        /// Whether measurement started, false when unsupported or every query still waits for the GPU
+        pub fn begin(self: *Self, tag: Tag) bool {
+            std.debug.assert(self.active == null);
+            if (!isSupported()) return false;
+
+            if (!self.is_initialized) {
+                c.glGenQueries(query_count, &self.queries);
+                self.is_initialized = true;
+            }
+
+            if (self.tags[self.next] != null) return false;
+
+            c.glBeginQuery(c.GL_TIME_ELAPSED, self.queries[self.next]);
+            self.tags[self.next] = tag;
+            self.active = self.next;
+            self.next = (self.next + 1) % query_count;
+
+            return true;
+        }
+
+        /// Stops measurement started by `begin()`
+        pub fn end(self: *Self) void {
+            if (self.active == null) return;
+
+            c.glEndQuery(c.GL_TIME_ELAPSED);
+            self.active = null;
+        }
+
+        /// Takes oldest finished measurement, null when GPU is not done with it yet. Call until it returns null.
+        pub fn poll(self: *Self) ?Result {
+            for (0..query_count) |i| {
+                const index = (self.next + i) % query_count;
+                if (self.active == index) return null;
+
+                const tag = self.tags[index] orelse continue;
+
+                // Queries finish in order, nothing after an unfinished one is ready either
+                var available: c.GLuint = 0;
+                c.glGetQueryObjectuiv(self.queries[index], c.GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available == 0) return null;
+
+                var ns: c.GLuint64 = 0;
+                c.glGetQueryObjectui64v(self.queries[index], c.GL_QUERY_RESULT, &ns);
+                self.tags[index] = null;
+
+                return .{ .tag = tag, .ns = ns };
+            }
+
+            return null;
+        }
+    };
+}
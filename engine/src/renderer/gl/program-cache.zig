@@ -0,0 +1,218 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const frame_constants = @import("frame-constants.zig");
+
+/// Directory program binaries are written to, relative to working directory
+const cache_directory = ".glaze-cache/programs";
+
+const magic = [4]u8{ 'G', 'L', 'Z', 'P' };
+const format_version = 1;
+
+/// Binaries larger than this are not a program this engine built
+const max_binary_size = 16 * 1024 * 1024;
+
+/// Start of every program binary file, driver's binary follows right after it
+const BinaryHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    key: u64, // Catches path hash collisions, file name is derived from the same key
+    binary_format: c.GLenum,
+    length: u32,
+};
+
+var driver_hash: ?u64 = null;
+
+/// Builds shader programs, reusing driver binaries from disk when sources and driver did not change.
+/// Binaries are keyed by hash of both sources, frame constants prelude and GL vendor, renderer and version strings,
+/// so a driver update or a different GPU simply misses the cache.
+pub const ProgramCache = struct {
+    /// Returns linked program for sources, from cache when possible. Must be called on the GL thread.
+    ///
+    /// # Errors
+    /// - `ShaderCompileFailed`: Source did not compile, log is printed
+    /// - `ProgramLinkFailed`: Shaders did not link, log is printed
+    pub fn loadOrLink(vertex_src: [:0]const u8, fragment_src: [:0]const u8) !c.GLuint {
+        if (!isSupported()) return linkProgram(vertex_src, fragment_src, false);
+
+        const key = makeKey(vertex_src, fragment_src);
+
+        var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+        const path = try std.fmt.bufPrint(&path_buffer, "{s}/{x:0>16}.bin", .{ cache_directory, key });
+
+        if (loadBinary(path, key)) |program| {
+            return program;
+        } else |e| switch (e) {
+            error.FileNotFound => {},
+            else => std.log.info("Program binary {s} not used: {}", .{ path, e }),
+        }
+
+        const program = try linkProgram(vertex_src, fragment_src, true);
+        storeBinary(path, key, program) catch |e| {
+            std.log.warn("Failed to store program binary {s}: {}", .{ path, e });
+        };
+
+        return program;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    /// Program binaries are core in GL 4.1, driver also has to offer at least one format
+    fn isSupported() bool {
+        if (c.GLAD_GL_VERSION_4_1 == 0) return false;
+
+        var format_count: c.GLint = 0;
+        c.glGetIntegerv(c.GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        return format_count > 0;
+    }
+
+    fn makeKey(vertex_src: []const u8, fragment_src: []const u8) u64 {
+        var hasher = std.hash.Wyhash.init(getDriverHash());
+        hasher.update(frame_constants.getPrelude());
+        hasher.update(vertex_src);
+        hasher.update(&.{0}); // Keeps "ab" + "c" apart from "a" + "bc"
+        hasher.update(fragment_src);
+        return hasher.final();
+    }
+
+    fn getDriverHash() u64 {
+        if (driver_hash) |hash| return hash;
+
+        var hasher = std.hash.Wyhash.init(format_version);
+        for ([_]c.GLenum{ c.GL_VENDOR, c.GL_RENDERER, c.GL_VERSION }) |name| {
+            const value = c.glGetString(name);
+            if (value != null) hasher.update(std.mem.span(@as([*:0]const u8, @ptrCast(value))));
+            hasher.update(&.{0});
+        }
+
+        driver_hash = hasher.final();
+        return driver_hash.?;
+    }
+
+    fn loadBinary(path: []const u8, key: u64) !c.GLuint {
+        const allocator = std.heap.c_allocator;
+
+        const bytes = try std.fs.cwd().readFileAlloc(allocator, path, max_binary_size);
+        defer allocator.free(bytes);
+
+        if (bytes.len < @sizeOf(BinaryHeader)) return ProgramCacheError.InvalidBinary;
+
+        const header = std.mem.bytesToValue(BinaryHeader, bytes[0..@sizeOf(BinaryHeader)]);
+        if (!std.mem.eql(u8, &header.magic, &magic) or header.version != format_version) return ProgramCacheError.InvalidBinary;
+        if (header.key != key) return ProgramCacheError.InvalidBinary;
+        if (bytes.len - @sizeOf(BinaryHeader) != header.length) return ProgramCacheError.InvalidBinary;
+
+        const binary = bytes[@sizeOf(BinaryHeader)..];
+
+        const program = c.glCreateProgram();
+        c.glProgramBinary(program, header.binary_format, binary.ptr, @intCast(binary.len));
+
+        // Driver may reject binaries it wrote itself, e.g. after an update that kept version string
+        var success: c.GLint = 0;
+        c.glGetProgramiv(program, c.GL_LINK_STATUS, &success);
+        if (success == 0) {
+            c.glDeleteProgram(program);
+            return ProgramCacheError.BinaryRejected;
+        }
+
+        return program;
+    }
+
+    fn storeBinary(path: []const u8, key: u64, program: c.GLuint) !void {
+        const allocator = std.heap.c_allocator;
+
+        var length: c.GLint = 0;
+        c.glGetProgramiv(program, c.GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return ProgramCacheError.InvalidBinary;
+
+        const bytes = try allocator.alloc(u8, @sizeOf(BinaryHeader) + @as(usize, @intCast(length)));
+        defer allocator.free(bytes);
+
+        var written: c.GLsizei = 0;
+        var binary_format: c.GLenum = 0;
+        c.glGetProgramBinary(program, length, &written, &binary_format, bytes[@sizeOf(BinaryHeader)..].ptr);
+        if (written <= 0) return ProgramCacheError.InvalidBinary;
+
+        const header = BinaryHeader{
+            .magic = magic,
+            .version = format_version,
+            .key = key,
+            .binary_format = binary_format,
+            .length = @intCast(written),
+        };
+        @memcpy(bytes[0..@sizeOf(BinaryHeader)], std.mem.asBytes(&header));
+
+        const cwd = std.fs.cwd();
+        try cwd.makePath(cache_directory);
+
+        // Temporary file first so a crash never leaves a half written binary behind
+        var temp_buffer: [std.fs.max_path_bytes]u8 = undefined;
+        const temp_path = try std.fmt.bufPrint(&temp_buffer, "{s}.tmp", .{path});
+
+        try cwd.writeFile(.{ .sub_path = temp_path, .data = bytes[0 .. @sizeOf(BinaryHeader) + @as(usize, @intCast(written))] });
+        try cwd.rename(temp_path, path);
+    }
+
+    fn linkProgram(vertex_src: [:0]const u8, fragment_src: [:0]const u8, retrievable: bool) !c.GLuint {
+        const vs = try compileShader(c.GL_VERTEX_SHADER, vertex_src);
+        defer c.glDeleteShader(vs);
+
+        const fs = try compileShader(c.GL_FRAGMENT_SHADER, fragment_src);
+        defer c.glDeleteShader(fs);
+
+        const program = c.glCreateProgram();
+        c.glAttachShader(program, vs);
+        c.glAttachShader(program, fs);
+
+        // Binary can only be read back if driver was told before linking
+        if (retrievable) c.glProgramParameteri(program, c.GL_PROGRAM_BINARY_RETRIEVABLE_HINT, c.GL_TRUE);
+
+        c.glLinkProgram(program);
+
+        var success: c.GLint = 0;
+        c.glGetProgramiv(program, c.GL_LINK_STATUS, &success);
+        if (success == 0) {
+            var buf: [512]u8 = undefined;
+            var len: c.GLsizei = 0;
+            c.glGetProgramInfoLog(program, buf.len, &len, &buf);
+            std.debug.print("Program link failed: {s}\n", .{buf[0..@intCast(len)]});
+            c.glDeleteProgram(program);
+            return error.ProgramLinkFailed;
+        }
+
+        return program;
+    }
+
+    fn compileShader(kind: c.GLenum, source: [:0]const u8) !c.GLuint {
+        const shader = c.glCreateShader(kind);
+
+        // Frame constants are declared right after #version, so every material can use them without declaring them
+        const prelude = frame_constants.getPrelude();
+        const first_line_end = std.mem.indexOfScalar(u8, source, '\n') orelse source.len;
+        const version_end = if (std.mem.startsWith(u8, source, "#version")) @min(first_line_end + 1, source.len) else 0;
+
+        const srcs = [_][*c]const u8{ source.ptr, prelude.ptr, source.ptr + version_end };
+        const lengths = [_]c.GLint{ @intCast(version_end), @intCast(prelude.len), @intCast(source.len - version_end) };
+        c.glShaderSource(shader, srcs.len, &srcs, &lengths);
+        c.glCompileShader(shader);
+
+        var success: c.GLint = 0;
+        c.glGetShaderiv(shader, c.GL_COMPILE_STATUS, &success);
+        if (success == 0) {
+            var buf: [512]u8 = undefined;
+            var len: c.GLsizei = 0;
+            c.glGetShaderInfoLog(shader, buf.len, &len, &buf);
+            std.debug.print("Shader compile failed: {s}\n", .{buf[0..@intCast(len)]});
+            c.glDeleteShader(shader);
+            return error.ShaderCompileFailed;
+        }
+        return shader;
+    }
+};
+
+pub const ProgramCacheError = error{
+    InvalidBinary,
+    BinaryRejected,
+};
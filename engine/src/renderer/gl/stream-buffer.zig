@@ -0,0 +1,265 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const GlState = @import("gl-state.zig").GlState;
+
+/// Frames that may be queued on the GPU at once, each gets its own region of the ring
+const frames_in_flight = 3;
+
+/// Upper bound for a single fence wait, after that we log and keep waiting
+const fence_timeout_ns = std.time.ns_per_s;
+
+/// How data reaches the buffer, picked from what the context supports
+pub const StreamMode = enum {
+    /// Buffer stays mapped for its whole life (GL 4.4), writes are plain memcpy
+    PersistentMapped,
+    /// Each write maps its range unsynchronized (GL 3.2), fences keep regions safe
+    MapRange,
+    /// Buffer is orphaned at the start of every frame and written with glBufferSubData (GLES2)
+    Orphan,
+    /// No GL context, see `GlState.enableNullMode()`. Writes only advance offsets and stats.
+    Null,
+};
+
+/// Place where streamed data ended up
+pub const StreamAllocation = struct {
+    buffer: c.GLuint,
+    offset: usize,
+};
+
+pub const StreamBufferStats = struct {
+    bytes_written: usize = 0,
+    fence_waits: u64 = 0, // Frames where CPU had to wait for the GPU to release a region
+    grow_count: u64 = 0,
+};
+
+/// Ring buffer that per frame geometry is sub-allocated from.
+/// The ring is split into one region per frame in flight. At the start of a frame the region that
+/// is about to be reused is waited on with its fence, so data the GPU still reads is never overwritten.
+pub const StreamBuffer = struct {
+    mode: StreamMode,
+
+    buffer: c.GLuint,
+    region_size: usize,
+    mapped: ?[*]u8, // Whole ring, only in `PersistentMapped` mode
+
+    region_index: usize,
+    region_offset: usize, // Bytes used in current region
+    fences: [frames_in_flight]c.GLsync,
+
+    stats: StreamBufferStats,
+    is_initialized: bool,
+
+    /// Creates buffer description, GL objects are created on first `beginFrame()`
+    ///
+    /// # Arguments
+    /// - `region_size`: Bytes that can be streamed per frame before buffer has to grow
+    pub fn init(region_size: usize) StreamBuffer {
+        return StreamBuffer{
+            .mode = .Orphan,
+            .buffer = 0,
+            .region_size = region_size,
+            .mapped = null,
+            .region_index = 0,
+            .region_offset = 0,
+            .fences = .{null} ** frames_in_flight,
+            .stats = .{},
+            .is_initialized = false,
+        };
+    }
+
+    pub fn deinit(self: *StreamBuffer) void {
+        if (!self.is_initialized) return;
+
+        self.destroyStorage();
+        self.is_initialized = false;
+    }
+
+    /// Moves to the next region of the ring, waiting for the GPU if it still reads it
+    pub fn beginFrame(self: *StreamBuffer) void {
+        if (!self.is_initialized) {
+            self.mode = detectMode();
+            self.createStorage();
+            self.is_initialized = true;
+        }
+
+        self.region_index = (self.region_index + 1) % frames_in_flight;
+        self.region_offset = 0;
+        self.stats.bytes_written = 0;
+
+        switch (self.mode) {
+            .PersistentMapped, .MapRange => self.waitForRegion(self.region_index),
+            .Orphan => {
+                // Driver hands us fresh storage, the old one lives until GPU is done with it
+                GlState.get().bindArrayBuffer(self.buffer);
+                c.glBufferData(c.GL_ARRAY_BUFFER, @intCast(self.getCapacity()), null, c.GL_STREAM_DRAW);
+            },
+            .Null => {},
+        }
+    }
+
+    /// Marks region written this frame as in use by the GPU. Call after the last draw reading it.
+    pub fn endFrame(self: *StreamBuffer) void {
+        if (self.mode == .Orphan or self.mode == .Null) return;
+
+        if (self.fences[self.region_index] != null) c.glDeleteSync(self.fences[self.region_index]);
+        self.fences[self.region_index] = c.glFenceSync(c.GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    /// Copies `bytes` into current frame's region.
+    /// Grows the ring when region is full, which invalidates allocations made earlier this frame,
+    /// so callers should stream everything a draw needs before issuing it.
+    ///
+    /// # Arguments
+    /// - `bytes`: Data to stream
+    /// - `alignment`: Required alignment of the returned offset, power of two
+    pub fn write(self: *StreamBuffer, bytes: []const u8, alignment: usize) StreamAllocation {
+        std.debug.assert(self.is_initialized);
+
+        var start = std.mem.alignForward(usize, self.region_offset, alignment);
+        if (start + bytes.len > self.region_size) {
+            self.grow(bytes.len + alignment);
+            start = 0;
+        }
+
+        const offset = self.region_index * self.region_size + start;
+
+        switch (self.mode) {
+            .PersistentMapped => {
+                @memcpy(self.mapped.?[offset .. offset + bytes.len], bytes);
+            },
+            .MapRange => {
+                GlState.get().bindArrayBuffer(self.buffer);
+                const access = c.GL_MAP_WRITE_BIT | c.GL_MAP_UNSYNCHRONIZED_BIT | c.GL_MAP_INVALIDATE_RANGE_BIT;
+                const ptr = c.glMapBufferRange(c.GL_ARRAY_BUFFER, @intCast(offset), @intCast(bytes.len), access);
+
+                if (ptr) |destination| {
+                    @memcpy(@as([*]u8, @ptrCast(destination))[0..bytes.len], bytes);
+                    _ = c.glUnmapBuffer(c.GL_ARRAY_BUFFER);
+                } else {
+                    c.glBufferSubData(c.GL_ARRAY_BUFFER, @intCast(offset), @intCast(bytes.len), bytes.ptr);
+                }
+            },
+            .Orphan => {
+                GlState.get().bindArrayBuffer(self.buffer);
+                c.glBufferSubData(c.GL_ARRAY_BUFFER, @intCast(offset), @intCast(bytes.len), bytes.ptr);
+            },
+            .Null => {},
+        }
+
+        self.region_offset = start + bytes.len;
+        self.stats.bytes_written += bytes.len;
+
+        return StreamAllocation{ .buffer = self.buffer, .offset = offset };
+    }
+
+    pub fn getMode(self: *const StreamBuffer) StreamMode {
+        return self.mode;
+    }
+
+    pub fn getStats(self: *const StreamBuffer) StreamBufferStats {
+        return self.stats;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn getCapacity(self: *const StreamBuffer) usize {
+        return self.region_size * frames_in_flight;
+    }
+
+    fn detectMode() StreamMode {
+        if (GlState.get().isNull()) return .Null;
+        if (c.GLAD_GL_VERSION_4_4 != 0) return .PersistentMapped;
+        if (c.GLAD_GL_VERSION_3_2 != 0) return .MapRange;
+        return .Orphan;
+    }
+
+    fn createStorage(self: *StreamBuffer) void {
+        const gl_state = GlState.get();
+
+        self.buffer = gl_state.createBuffer();
+        gl_state.bindArrayBuffer(self.buffer);
+
+        switch (self.mode) {
+            .PersistentMapped => {
+                const flags = c.GL_MAP_WRITE_BIT | c.GL_MAP_PERSISTENT_BIT | c.GL_MAP_COHERENT_BIT;
+                c.glBufferStorage(c.GL_ARRAY_BUFFER, @intCast(self.getCapacity()), null, flags);
+
+                const ptr = c.glMapBufferRange(c.GL_ARRAY_BUFFER, 0, @intCast(self.getCapacity()), flags);
+                if (ptr) |mapped| {
+                    self.mapped = @ptrCast(mapped);
+                } else {
+                    // Immutable storage can not be reallocated, start over with a mutable buffer
+                    std.log.warn("Persistent mapping failed, streaming with glMapBufferRange", .{});
+                    gl_state.deleteBuffer(self.buffer);
+                    self.mode = .MapRange;
+                    self.createStorage();
+                }
+            },
+            .MapRange, .Orphan => {
+                c.glBufferData(c.GL_ARRAY_BUFFER, @intCast(self.getCapacity()), null, c.GL_STREAM_DRAW);
+            },
+            .Null => {},
+        }
+    }
+
+    fn destroyStorage(self: *StreamBuffer) void {
+        for (&self.fences) |*fence| {
+            if (fence.* != null) c.glDeleteSync(fence.*);
+            fence.* = null;
+        }
+
+        if (self.mapped != null) {
+            GlState.get().bindArrayBuffer(self.buffer);
+            _ = c.glUnmapBuffer(c.GL_ARRAY_BUFFER);
+            self.mapped = null;
+        }
+
+        GlState.get().deleteBuffer(self.buffer);
+    }
+
+    /// Replaces storage with a larger one. Driver keeps old storage alive until GPU is done with it.
+    fn grow(self: *StreamBuffer, min_region_size: usize) void {
+        self.destroyStorage();
+
+        self.region_size = @max(self.region_size * 2, min_region_size);
+        self.region_offset = 0;
+        self.stats.grow_count += 1;
+
+        self.createStorage();
+        std.log.info("Stream buffer grown to {} KiB per frame", .{self.region_size / 1024});
+    }
+
+    fn waitForRegion(self: *StreamBuffer, index: usize) void {
+        const fence = self.fences[index] orelse return;
+        defer {
+            c.glDeleteSync(fence);
+            self.fences[index] = null;
+        }
+
+        var flags: c.GLbitfield = 0;
+        var has_waited = false;
+
+        while (true) {
+            const result = c.glClientWaitSync(fence, flags, 0);
+            if (result == c.GL_ALREADY_SIGNALED or result == c.GL_CONDITION_SATISFIED) break;
+            if (result == c.GL_WAIT_FAILED) {
+                std.log.err("Waiting for stream buffer fence failed", .{});
+                break;
+            }
+
+            if (!has_waited) {
+                self.stats.fence_waits += 1;
+                has_waited = true;
+            }
+
+            // First poll did not flush, make sure the fence can ever signal before blocking on it
+            flags = c.GL_SYNC_FLUSH_COMMANDS_BIT;
+            if (c.glClientWaitSync(fence, flags, fence_timeout_ns) == c.GL_TIMEOUT_EXPIRED) {
+                std.log.warn("GPU still reads stream buffer region after 1s", .{});
+            }
+        }
+    }
+};
@@ -0,0 +1,268 @@
+const std = @import("std");
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const MaterialInstance = @import("../materials/material-instance.zig").MaterialInstance;
+const TextureRegion = @import("../textures/texture-manager.zig").TextureRegion;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+const radix_bits = 8;
+const bucket_count = 1 << radix_bits;
+const pass_count = @bitSizeOf(u64) / radix_bits;
+
+/// Queues smaller than this are sorted on the calling thread, spawning workers costs more than it saves
+const parallel_threshold = 32 * 1024;
+const max_workers = 8;
+
+/// Everything needed to draw a single sprite
+pub const SpriteDraw = struct {
+    material: *MaterialInstance,
+    region: TextureRegion,
+    model_matrix: [16]f32,
+    color: [4]f32,
+};
+
+/// Sort key together with index of the draw it belongs to
+pub const RenderItem = struct {
+    key: u64,
+    draw_index: u32,
+};
+
+/// Builds 64-bit sort key, most significant bits first: `layer:8 | depth:24 | translucent:1 | material:15 | texture:16`.
+/// Nothing is depth tested, so draw order alone decides what ends up on top and depth has to come right after layer.
+/// Sprites at the same depth are grouped by state, opaque ones before translucent ones.
+///
+/// # Arguments
+/// - `layer`: Sorting layer, higher layers are drawn later
+/// - `translucent`: Whether sprite is partially transparent and has to be blended over what is below it
+/// - `material_id`: `MaterialInstance.id`
+/// - `texture`: GL texture name
+/// - `depth`: Z position, lower values are drawn first
+pub fn makeSortKey(layer: u8, translucent: bool, material_id: u16, texture: u32, depth: f32) u64 {
+    const material: u64 = material_id & 0x7FFF;
+    const texture_bits: u64 = texture & 0xFFFF;
+    const depth_bits: u64 = depthToBits(depth);
+
+    var key: u64 = @as(u64, layer) << 56;
+    key |= depth_bits << 32;
+    key |= @as(u64, @intFromBool(translucent)) << 31;
+    key |= material << 16;
+    key |= texture_bits;
+
+    return key;
+}
+
+/// Collects sprites visible this frame and sorts them by key with an LSD radix sort
+pub const RenderQueue = struct {
+    allocator: Allocator,
+
+    draws: ArrayList(SpriteDraw),
+    items: ArrayList(RenderItem),
+    scratch: ArrayList(RenderItem),
+
+    worker_pool: ?*std.Thread.Pool,
+    is_parallel_enabled: bool,
+
+    pub fn init(allocator: Allocator) RenderQueue {
+        return RenderQueue{
+            .allocator = allocator,
+            .draws = ArrayList(SpriteDraw){},
+            .items = ArrayList(RenderItem){},
+            .scratch = ArrayList(RenderItem){},
+            .worker_pool = null,
+            .is_parallel_enabled = true,
+        };
+    }
+
+    pub fn deinit(self: *RenderQueue) void {
+        if (self.worker_pool) |pool| {
+            pool.deinit();
+            cFree(pool);
+        }
+
+        self.draws.deinit(self.allocator);
+        self.items.deinit(self.allocator);
+        self.scratch.deinit(self.allocator);
+    }
+
+    pub fn clear(self: *RenderQueue) void {
+        self.draws.clearRetainingCapacity();
+        self.items.clearRetainingCapacity();
+    }
+
+    pub fn submit(self: *RenderQueue, key: u64, draw: SpriteDraw) !void {
+        const index: u32 = @intCast(self.draws.items.len);
+
+        try self.draws.append(self.allocator, draw);
+        try self.items.append(self.allocator, RenderItem{ .key = key, .draw_index = index });
+    }
+
+    /// Large queues are sorted on worker threads unless disabled
+    pub fn setParallelSort(self: *RenderQueue, enabled: bool) void {
+        self.is_parallel_enabled = enabled;
+    }
+
+    /// Sorts submitted items by key, equal keys keep submission order
+    pub fn sort(self: *RenderQueue) !void {
+        const count = self.items.items.len;
+        if (count < 2) return;
+
+        try self.scratch.resize(self.allocator, count);
+
+        if (self.is_parallel_enabled and count >= parallel_threshold) {
+            if (self.getWorkerPool()) |pool| {
+                self.sortParallel(pool);
+                return;
+            } else |e| {
+                std.log.warn("Render queue falls back to single threaded sort: {}", .{e});
+            }
+        }
+
+        self.sortSingleThreaded();
+    }
+
+    /// Items in draw order, valid until next `clear()`
+    pub fn getSorted(self: *const RenderQueue) []const RenderItem {
+        return self.items.items;
+    }
+
+    pub fn getDraw(self: *const RenderQueue, item: RenderItem) *const SpriteDraw {
+        return &self.draws.items[item.draw_index];
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn sortSingleThreaded(self: *RenderQueue) void {
+        var source = self.items.items;
+        var destination = self.scratch.items;
+
+        // Histograms of every digit are built in one pass over the keys
+        var histograms: [pass_count][bucket_count]u32 = .{.{0} ** bucket_count} ** pass_count;
+        for (source) |item| {
+            inline for (0..pass_count) |pass| {
+                histograms[pass][digitOf(item.key, pass)] += 1;
+            }
+        }
+
+        for (0..pass_count) |pass| {
+            // Digit is the same for every key, pass would not move anything
+            if (isTrivialPass(&histograms[pass], source.len)) continue;
+
+            var offsets: [bucket_count]u32 = undefined;
+            var running: u32 = 0;
+            for (histograms[pass], 0..) |count, bucket| {
+                offsets[bucket] = running;
+                running += count;
+            }
+
+            for (source) |item| {
+                const digit = digitOf(item.key, pass);
+                destination[offsets[digit]] = item;
+                offsets[digit] += 1;
+            }
+
+            std.mem.swap([]RenderItem, &source, &destination);
+        }
+
+        if (source.ptr != self.items.items.ptr) @memcpy(self.items.items, source);
+    }
+
+    fn sortParallel(self: *RenderQueue, pool: *std.Thread.Pool) void {
+        const count = self.items.items.len;
+        const worker_count = @min(max_workers, @max(1, count / (parallel_threshold / 2)));
+        const chunk_size = (count + worker_count - 1) / worker_count;
+
+        var source = self.items.items;
+        var destination = self.scratch.items;
+
+        var histograms: [max_workers][bucket_count]u32 = undefined;
+        var offsets: [max_workers][bucket_count]u32 = undefined;
+
+        for (0..pass_count) |pass| {
+            var wait_group = std.Thread.WaitGroup{};
+            for (0..worker_count) |worker| {
+                pool.spawnWg(&wait_group, countDigits, .{ chunkOf(source, worker, chunk_size), pass, &histograms[worker] });
+            }
+            pool.waitAndWork(&wait_group);
+
+            // Every bucket is split between chunks in chunk order, which keeps the sort stable
+            var running: u32 = 0;
+            var is_trivial = false;
+            for (0..bucket_count) |bucket| {
+                var bucket_total: u32 = 0;
+                for (0..worker_count) |worker| {
+                    offsets[worker][bucket] = running;
+                    running += histograms[worker][bucket];
+                    bucket_total += histograms[worker][bucket];
+                }
+
+                if (bucket_total == count) is_trivial = true;
+            }
+
+            if (is_trivial) continue;
+
+            wait_group.reset();
+            for (0..worker_count) |worker| {
+                pool.spawnWg(&wait_group, scatterDigits, .{ chunkOf(source, worker, chunk_size), destination, pass, &offsets[worker] });
+            }
+            pool.waitAndWork(&wait_group);
+
+            std.mem.swap([]RenderItem, &source, &destination);
+        }
+
+        if (source.ptr != self.items.items.ptr) @memcpy(self.items.items, source);
+    }
+
+    fn countDigits(items: []const RenderItem, pass: usize, histogram: *[bucket_count]u32) void {
+        histogram.* = .{0} ** bucket_count;
+        for (items) |item| histogram[digitOf(item.key, pass)] += 1;
+    }
+
+    fn scatterDigits(items: []const RenderItem, destination: []RenderItem, pass: usize, offsets: *[bucket_count]u32) void {
+        for (items) |item| {
+            const digit = digitOf(item.key, pass);
+            destination[offsets[digit]] = item;
+            offsets[digit] += 1;
+        }
+    }
+
+    fn chunkOf(items: []RenderItem, worker: usize, chunk_size: usize) []RenderItem {
+        const start = @min(worker * chunk_size, items.len);
+        const end = @min(start + chunk_size, items.len);
+        return items[start..end];
+    }
+
+    fn getWorkerPool(self: *RenderQueue) !*std.Thread.Pool {
+        if (self.worker_pool) |pool| return pool;
+
+        const pool = try cAlloc(std.Thread.Pool);
+        errdefer cFree(pool);
+
+        try pool.init(.{ .allocator = self.allocator, .n_jobs = max_workers - 1 });
+        self.worker_pool = pool;
+
+        return pool;
+    }
+};
+
+fn digitOf(key: u64, pass: usize) usize {
+    return @intCast((key >> @intCast(pass * radix_bits)) & (bucket_count - 1));
+}
+
+fn isTrivialPass(histogram: *const [bucket_count]u32, count: usize) bool {
+    for (histogram) |bucket| {
+        if (bucket == count) return true;
+    }
+
+    return false;
+}
+
+/// Maps float to 24 bits that sort in the same order as the float
+fn depthToBits(depth: f32) u64 {
+    const bits: u32 = @bitCast(depth);
+    const sortable = if (bits & 0x8000_0000 != 0) ~bits else bits | 0x8000_0000;
+    return sortable >> 8;
+}
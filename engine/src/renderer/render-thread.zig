@@ -0,0 +1,194 @@
+const std = @import("std");
+
+const GlContext = @import("gl/gl-context.zig").GlContext;
+const CommandList = @import("command-list.zig").CommandList;
+
+const Allocator = std.mem.Allocator;
+
+/// Executes a command list, called on the render thread
+pub const ExecuteFn = *const fn (list: *CommandList, data: ?*anyopaque) anyerror!void;
+
+/// Work that has to run where GL context is current, see `RenderThread.invoke()`
+const RenderTask = struct {
+    run: *const fn (?*anyopaque) anyerror!void,
+    data: ?*anyopaque,
+    result: anyerror!void = {},
+    is_done: bool = false,
+};
+
+/// Thread that owns GL context and executes command lists recorded on the frame thread.
+/// Lists are double buffered: while the render thread submits frame N, the frame thread simulates and records
+/// frame N + 1 into the other list. `submit()` only waits for frame N when frame N + 1 is ready to take its place.
+pub const RenderThread = struct {
+    lists: [2]CommandList,
+    recording_index: usize, // List owned by the frame thread
+
+    submitted: ?*CommandList, // List owned by the render thread until it was executed
+    task: ?*RenderTask,
+    has_failed: bool, // Context could not be made current or thread was stopped, lists are dropped
+    is_stopping: bool, // Set by `stop()`, thread exits once submitted list and task are done
+
+    mutex: std.Thread.Mutex,
+    condition: std.Thread.Condition, // Signalled whenever `submitted`, `task`, `has_failed` or `is_stopping` change
+
+    thread: ?std.Thread,
+    thread_id: ?std.Thread.Id,
+
+    execute: ExecuteFn,
+    execute_data: ?*anyopaque,
+
+    pub fn init(allocator: Allocator, execute: ExecuteFn, execute_data: ?*anyopaque) RenderThread {
+        return RenderThread{
+            .lists = .{ CommandList.init(allocator), CommandList.init(allocator) },
+            .recording_index = 0,
+            .submitted = null,
+            .task = null,
+            .has_failed = false,
+            .is_stopping = false,
+            .mutex = .{},
+            .condition = .{},
+            .thread = null,
+            .thread_id = null,
+            .execute = execute,
+            .execute_data = execute_data,
+        };
+    }
+
+    /// Moves `context` from calling thread onto a new render thread. Must be called on the thread context is current on.
+    pub fn start(self: *RenderThread, context: *GlContext) !void {
+        std.debug.assert(self.thread == null);
+
+        context.release_current(context);
+        self.thread = try std.Thread.spawn(.{}, run, .{ self, context });
+    }
+
+    /// Finishes list and task in flight, releases GL context and joins render thread.
+    /// Lists submitted afterwards are dropped. Does nothing if thread was never started.
+    pub fn stop(self: *RenderThread) void {
+        const thread = self.thread orelse return;
+
+        self.mutex.lock();
+        self.is_stopping = true;
+        self.condition.broadcast();
+        self.mutex.unlock();
+
+        thread.join();
+        self.thread = null;
+    }
+
+    pub fn isStarted(self: *const RenderThread) bool {
+        return self.thread != null;
+    }
+
+    /// Whether caller is the render thread
+    pub fn isRenderThread(self: *RenderThread) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const id = self.thread_id orelse return false;
+        return id == std.Thread.getCurrentId();
+    }
+
+    /// List the frame thread records into, cleared and owned by it until `submit()`
+    pub fn getRecordingList(self: *RenderThread) *CommandList {
+        return &self.lists[self.recording_index];
+    }
+
+    /// Hands recording list to render thread, waiting for the previous one to finish first.
+    /// Frame thread only.
+    pub fn submit(self: *RenderThread) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        while (self.submitted != null and !self.has_failed) self.condition.wait(&self.mutex);
+
+        const list = &self.lists[self.recording_index];
+        if (self.has_failed) {
+            list.clear();
+            return;
+        }
+
+        self.submitted = list;
+        self.recording_index ^= 1;
+        self.condition.broadcast();
+    }
+
+    /// Runs `task` on render thread between two lists and waits for it, or right away when called on the render thread.
+    /// Blocks until render thread was started if it was not yet.
+    ///
+    /// # Errors
+    /// - Whatever `task` returned
+    /// - `RenderThreadFailed`: Render thread could not take over GL context
+    pub fn invoke(self: *RenderThread, task: *const fn (?*anyopaque) anyerror!void, data: ?*anyopaque) !void {
+        if (self.isRenderThread()) return task(data);
+
+        var pending = RenderTask{ .run = task, .data = data };
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        while (self.task != null and !self.has_failed) self.condition.wait(&self.mutex);
+        if (self.has_failed) return RenderThreadError.RenderThreadFailed;
+
+        self.task = &pending;
+        self.condition.broadcast();
+
+        while (!pending.is_done and !self.has_failed) self.condition.wait(&self.mutex);
+        if (!pending.is_done) return RenderThreadError.RenderThreadFailed;
+
+        return pending.result;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn run(self: *RenderThread, context: *GlContext) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.thread_id = std.Thread.getCurrentId();
+
+        context.make_current(context) catch |e| {
+            std.log.err("Render thread could not make GL context current, nothing will be drawn: {}", .{e});
+            self.has_failed = true;
+            self.condition.broadcast();
+            return;
+        };
+
+        defer {
+            context.release_current(context);
+            self.has_failed = true;
+            self.condition.broadcast();
+        }
+
+        while (true) {
+            while (self.submitted == null and self.task == null and !self.is_stopping) self.condition.wait(&self.mutex);
+
+            if (self.task) |task| {
+                self.mutex.unlock();
+                task.result = task.run(task.data);
+                self.mutex.lock();
+
+                task.is_done = true;
+                self.task = null;
+                self.condition.broadcast();
+                continue;
+            }
+
+            const list = self.submitted orelse return;
+
+            // Frame thread records into the other list meanwhile, this one is not touched by it until released
+            self.mutex.unlock();
+            self.execute(list, self.execute_data) catch |e| {
+                std.log.err("Failed to execute command list: {}", .{e});
+            };
+            list.clear();
+            self.mutex.lock();
+
+            self.submitted = null;
+            self.condition.broadcast();
+        }
+    }
+};
+
+pub const RenderThreadError = error{
+    RenderThreadFailed,
+};
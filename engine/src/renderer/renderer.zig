@@ -2,12 +2,21 @@ const std = @import("std");
 
 const App = @import("../app.zig").App;
 const Gl = @import("gl/gl.zig").Gl;
+const gl_state_module = @import("gl/gl-state.zig");
+const GlState = gl_state_module.GlState;
+const GlStateStats = gl_state_module.GlStateStats;
+const FrameConstantsBuffer = @import("gl/frame-constants.zig").FrameConstantsBuffer;
+const StreamBuffer = @import("gl/stream-buffer.zig").StreamBuffer;
+const GpuTimer = @import("gl/gpu-timer.zig").GpuTimer;
 
 const c = @cImport({
     @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
 });
 
 const TextureManager = @import("../textures/texture-manager.zig").TextureManager;
+const TextureRegion = @import("../textures/texture-manager.zig").TextureRegion;
+const TextureStats = @import("../textures/texture-manager.zig").TextureStats;
+const TextureHandle = @import("../textures/texture-manager.zig").TextureHandle;
 
 const SpriteRenderer = @import("../components/sprite-renderer.zig").SpriteRenderer;
 const Transform = @import("../components/transform.zig").Transform;
@@ -17,7 +26,30 @@ const EventDispatcher = @import("../event-system/event_dispatcher.zig").EventDis
 const Caster = @import("../utils/caster.zig");
 const Platform = @import("../utils/platform.zig");
 const Window = @import("window.zig").Window;
+const SpriteBatcher = @import("sprite-batcher.zig").SpriteBatcher;
+const SpriteInstancer = @import("sprite-instancer.zig").SpriteInstancer;
+const render_queue_module = @import("render-queue.zig");
+const RenderQueue = render_queue_module.RenderQueue;
+const SpriteDraw = render_queue_module.SpriteDraw;
+const makeSortKey = render_queue_module.makeSortKey;
+const command_list = @import("command-list.zig");
+const CommandList = command_list.CommandList;
+const SpriteCommand = command_list.SpriteCommand;
+const RenderThread = @import("render-thread.zig").RenderThread;
+const frame_stats = @import("frame-stats.zig");
+const FrameStats = frame_stats.FrameStats;
+const FrameStatsHistory = frame_stats.FrameStatsHistory;
+const FrameStatsSummary = frame_stats.FrameStatsSummary;
+const FrameStatsDumpTarget = frame_stats.FrameStatsDumpTarget;
+const sprite_path = @import("sprite-path.zig");
+const SpritePath = sprite_path.SpritePath;
+const SpritePathSelector = sprite_path.SpritePathSelector;
 const TypeCache = @import("../utils/type-cache.zig").TypeCache;
+const material_instance = @import("../materials/material-instance.zig");
+const Material = @import("../materials/material.zig").Material;
+const MaterialInstance = material_instance.MaterialInstance;
+const MaterialInstanceCache = material_instance.MaterialInstanceCache;
+const ParamBlock = material_instance.ParamBlock;
 const allocateNewArena = @import("../utils/arena_allocator_util.zig").allocateNewArena;
 
 const PlatformRenderer = VerifyPlatformRenderer(switch (Platform.current_platform) {
@@ -28,26 +60,61 @@ const PlatformRenderer = VerifyPlatformRenderer(switch (Platform.current_platfor
 
 var renderer_instance: ?*Renderer = null;
 
+/// Bytes of sprite geometry streamed per frame before stream buffer has to grow
+const stream_region_size = 1024 * 1024;
+
+/// Time per frame spent uploading decoded textures, at least one texture is uploaded regardless
+const texture_upload_budget_ns = 2 * std.time.ns_per_ms;
+
+/// What renderer does on frames where nothing it tracks changed, see `Renderer.requestRedraw()`
+pub const IdleMode = enum {
+    Off, // Every frame is built and drawn
+    SkipRedraw, // Frame handlers still run, building and drawing is skipped. Acts as `PauseFrames` on Wayland, see `Window.can_skip_frames`.
+    PauseFrames, // Like `SkipRedraw`, and platforms that support it stop requesting frames until something changes. Never pauses while timers are pending.
+};
+
 const RendererOptions = struct {
     width: i32 = 800,
     height: i32 = 600,
     title: [*:0]const u8 = "My Game",
+    idle_mode: IdleMode = .Off,
 };
 
 pub const Renderer = struct {
     app: *App,
     window: *Window,
 
-    vbo_handle: c.GLuint,
-    ebo_handle: c.GLuint,
-    vao_handle: c.GLuint,
-    are_buffers_initialized: bool = false,
+    sprite_batcher: SpriteBatcher,
+    sprite_instancer: SpriteInstancer,
+    render_queue: RenderQueue,
+    frame_constants: FrameConstantsBuffer,
+    stream_buffer: StreamBuffer,
+    start_timestamp: i128,
+    last_frame_timestamp: i128,
+    sprite_path: SpritePath = .Auto,
+    sprite_path_selector: SpritePathSelector = .{},
+    sprite_path_timer: GpuTimer(SpritePath) = .{}, // Times submission of sprites while `Auto` measures both paths
+    batched_scene_key: ?usize = null, // Scene that uses a material without instanced variant, drawn batched
+    last_gl_state_stats: GlStateStats = .{},
+    sprite_path_mutex: std.Thread.Mutex = .{}, // Guards sprite path, its selector and GL state stats, render thread updates them while any thread reads them
+    frame_stats_history: FrameStatsHistory,
+
+    idle_mode: IdleMode,
+    needs_redraw: std.atomic.Value(bool) = .init(true), // Something drawn changed since last frame was built
+    built_width: i32 = 0, // Window size last frame was built for
+    built_height: i32 = 0,
+
+    pending_prewarms: std.ArrayList(*const fn () anyerror!void) = .{}, // Queued by `prewarmMaterial()`, run on the render thread
+    pending_prewarms_mutex: std.Thread.Mutex = .{},
 
     initialized: bool = false,
 
     on_request_frame_event: *EventDispatcher(void, *anyopaque),
     material_cache: *TypeCache(std.heap.ArenaAllocator),
+    material_instances: MaterialInstanceCache,
+    material_mutex: std.Thread.Mutex = .{}, // Guards material cache and instances, build stage and render thread both create them
     texture_manager: TextureManager,
+    render_thread: RenderThread,
 
     pub fn makeOrthoProjectionMatrix(width: f32, height: f32) [16]f32 {
         const half_w_units = (width / 100.0) / 2.0;
@@ -68,99 +135,211 @@ pub const Renderer = struct {
         };
     }
 
+    /// Multiplies two column major 4x4 matrices
+    pub fn multiplyMatrices(a: *const [16]f32, b: *const [16]f32) [16]f32 {
+        var result: [16]f32 = undefined;
+
+        for (0..4) |column| {
+            for (0..4) |row| {
+                var sum: f32 = 0.0;
+                for (0..4) |k| sum += a[k * 4 + row] * b[column * 4 + k];
+                result[column * 4 + row] = sum;
+            }
+        }
+
+        return result;
+    }
+
+    /// Frame thread half of the frame: runs request frame handlers, records the scene into a command list and hands it
+    /// to the render thread, which meanwhile still submits the previous frame
     fn onRequestFrame(_: void, data: ?*anyopaque) !void {
         const self = try Caster.castFromNullableAnyopaque(Renderer, data);
 
+        // GL context is current on this thread, render thread takes it over before anything is drawn
+        if (!self.render_thread.isStarted()) try self.render_thread.start(self.window.gl.context);
+
         // Ignore errors to allow the render loop to run independently
         self.on_request_frame_event.dispatch({}) catch {};
 
-        c.glViewport(0, 0, self.window.width, self.window.height);
-        c.glClearColor(0.3, 0.0, 0.5, 1.0);
-        c.glClear(c.GL_COLOR_BUFFER_BIT);
+        // Previous frame is still on screen and still correct
+        if (!self.consumeRedraw()) return;
 
-        const scene = self.app.scene_manager.getActiveScene() catch {
-            try self.window.gl.context.swap_buffers(self.window.gl.context);
-            return;
+        const list = self.render_thread.getRecordingList();
+        var timer = std.time.Timer.start() catch null;
+
+        self.buildCommandList(list) catch |e| {
+            std.log.err("Failed to build command list: {}", .{e});
+            list.clear();
         };
 
-        // Initialize buffers only once for improved performance
-        if (!self.are_buffers_initialized) {
-            const vertices = [_]f32{
-                // x, y, u, v
-                -0.5, 0.5, 0.0, 1.0, // top-left
-                -0.5, -0.5, 0.0, 0.0, // bottom-left
-                0.5, -0.5, 1.0, 0.0, // bottom-right
-                0.5, 0.5, 1.0, 1.0, // top-right
-            };
+        if (timer) |*build_timer| list.build_ns = build_timer.read();
+
+        self.render_thread.submit();
+    }
+
+    /// Render thread half of the frame: uploads, sorts and submits what the build stage recorded, then presents it
+    fn executeCommandList(list: *CommandList, data: ?*anyopaque) !void {
+        const self = try Caster.castFromNullableAnyopaque(Renderer, data);
+        var timer = std.time.Timer.start() catch null;
+
+        // Keep last frame's counters around for profiling before starting new ones
+        const gl_state = GlState.get();
+        self.sprite_path_mutex.lock();
+        self.last_gl_state_stats = gl_state.getStats();
+        self.sprite_path_mutex.unlock();
+        gl_state.resetStats();
+
+        gl_state.setViewport(0, 0, list.width, list.height);
+        gl_state.setBlend(true);
+        gl_state.setBlendFunc(c.GL_SRC_ALPHA, c.GL_ONE_MINUS_SRC_ALPHA);
+        gl_state.clear(0.3, 0.0, 0.5, 1.0);
 
-            const indices = [_]u32{
-                0, 1, 2, // first triangle
-                2, 3, 0, // second triangle
+        self.runPrewarms();
+
+        self.texture_manager.processUploads(texture_upload_budget_ns) catch |e| {
+            std.log.err("Failed to upload textures: {}", .{e});
+        };
+        self.texture_manager.updateResidency();
+
+        var stats = FrameStats{
+            .sprites_culled = list.culled_count,
+            .build_ns = list.build_ns,
+        };
+
+        if (list.view) |view| {
+            self.frame_constants.update(&view.view_projection, view.viewport, view.time, view.delta);
+
+            try self.buildRenderQueue(list.getSprites());
+
+            // Fence is placed after the last draw that reads this frame's region
+            self.stream_buffer.beginFrame();
+            defer self.stream_buffer.endFrame();
+
+            const path = self.resolveSpritePath(view.scene_key, view.object_count);
+
+            const batch_count = blk: {
+                // GPU time is what the paths differ in, CPU side only measures how fast driver queues commands
+                const is_timed = self.getSpritePath() == .Auto and self.sprite_path_timer.begin(path);
+                defer if (is_timed) self.sprite_path_timer.end();
+
+                break :blk switch (path) {
+                    .Instanced => self.submitSprites(&self.sprite_instancer) catch |e| switch (e) {
+                        error.MaterialNotInstanced => fallback: {
+                            std.log.warn("Scene uses material without instanced variant, drawing it with batched sprites", .{});
+                            self.batched_scene_key = view.scene_key;
+                            self.chooseBatchedPath();
+
+                            break :fallback try self.submitSprites(&self.sprite_batcher);
+                        },
+                        else => return e,
+                    },
+                    else => try self.submitSprites(&self.sprite_batcher),
+                };
             };
 
-            c.glGenBuffers(1, &self.vbo_handle);
-            c.glBindBuffer(c.GL_ARRAY_BUFFER, self.vbo_handle);
-            c.glBufferData(c.GL_ARRAY_BUFFER, @sizeOf(@TypeOf(vertices)), &vertices, c.GL_STATIC_DRAW);
+            while (self.sprite_path_timer.poll()) |result| {
+                self.sprite_path_mutex.lock();
+                defer self.sprite_path_mutex.unlock();
 
-            c.glGenBuffers(1, &self.ebo_handle);
-            c.glBindBuffer(c.GL_ELEMENT_ARRAY_BUFFER, self.ebo_handle);
-            c.glBufferData(c.GL_ELEMENT_ARRAY_BUFFER, @sizeOf(@TypeOf(indices)), &indices, c.GL_STATIC_DRAW);
+                self.sprite_path_selector.record(result.tag, result.ns);
+            }
 
-            self.are_buffers_initialized = true;
+            stats.batches = batch_count;
+            stats.sprites_drawn = list.getSprites().len;
+            stats.bytes_streamed = self.stream_buffer.getStats().bytes_written;
         }
 
-        if (scene.camera) |cameraObj| {
-            // We need to obtain lock on active game objects to prevent invalid game objects access
-            scene.active_game_objects_mutex.lock();
+        const gl_stats = gl_state.getStats();
+        stats.draw_calls = gl_stats.draw_calls;
+        stats.vertices = gl_stats.vertices;
+        stats.state_changes = gl_stats.issued_calls;
+        stats.skipped_state_changes = gl_stats.skipped_calls;
+        stats.texture_binds = gl_stats.texture_binds;
+        if (timer) |*submit_timer| stats.submit_ns = submit_timer.read();
 
-            var game_objects = try scene.getActiveGameObjects();
+        self.frame_stats_history.push(stats);
 
-            const proj_matrix = makeOrthoProjectionMatrix(@floatFromInt(self.window.width), @floatFromInt(self.window.height));
+        // Textures still loading or streaming in change the picture on their own
+        if (self.texture_manager.hasPendingWork()) self.markDirty();
 
-            const camera = cameraObj.getComponent(Camera2D) orelse return error.InvalidCamera;
-            const view_matrix = camera.makeViewMatrix();
+        try self.window.gl.context.swap_buffers(self.window.gl.context);
+    }
 
-            for (game_objects.items) |obj| {
-                const transform = obj.getComponent(Transform) orelse continue;
-                const renderer = obj.getComponent(SpriteRenderer("")) orelse continue;
+    /// Selects how sprites are submitted. `Auto` times both paths on the active scene and keeps the faster one.
+    /// Safe to call from any thread.
+    pub fn setSpritePath(self: *Renderer, path: SpritePath) void {
+        self.sprite_path_mutex.lock();
+        defer self.sprite_path_mutex.unlock();
 
-                const material = try renderer.getMaterial();
-                c.glUseProgram(material.program);
+        self.sprite_path = path;
+        self.sprite_path_selector = .{};
+    }
 
-                // bind matrices
-                const model_matrix = transform.get2DMatrix();
-                c.glUniformMatrix4fv(material.model_matrix_uniform_location, 1, c.GL_FALSE, &model_matrix);
-                c.glUniformMatrix4fv(material.view_matrix_uniform_location, 1, c.GL_FALSE, &view_matrix);
-                c.glUniformMatrix4fv(material.projection_matrix_uniform_location, 1, c.GL_FALSE, &proj_matrix);
+    pub fn getSpritePath(self: *Renderer) SpritePath {
+        self.sprite_path_mutex.lock();
+        defer self.sprite_path_mutex.unlock();
 
-                // bind texture
-                if (renderer.getSpriteTexture()) |tex| {
-                    c.glActiveTexture(c.GL_TEXTURE0);
-                    c.glBindTexture(c.GL_TEXTURE_2D, tex);
-                    c.glUniform1i(material.texture_uniform_location, 0);
-                }
+        return self.sprite_path;
+    }
 
-                c.glBindBuffer(c.GL_ARRAY_BUFFER, self.vbo_handle);
-                c.glBindBuffer(c.GL_ELEMENT_ARRAY_BUFFER, self.ebo_handle);
+    /// Selects whether frames where nothing changed are skipped. Changes are tracked through transform, sprite renderer
+    /// and camera setters, scene membership, active scene, window size and texture loads. Fields written directly and
+    /// materials animated by time are not tracked, call `requestRedraw()` for them.
+    pub fn setIdleMode(self: *Renderer, mode: IdleMode) void {
+        self.idle_mode = mode;
+        self.markDirty();
+    }
 
-                c.glUniform4fv(material.color_uniform_location, 1, renderer.color);
+    pub fn getIdleMode(self: *Renderer) IdleMode {
+        return self.idle_mode;
+    }
 
-                const stride = 4 * @sizeOf(f32);
+    /// GL calls issued and skipped by state cache during last frame. Safe to call from any thread.
+    pub fn getGlStateStats(self: *Renderer) GlStateStats {
+        self.sprite_path_mutex.lock();
+        defer self.sprite_path_mutex.unlock();
 
-                c.glEnableVertexAttribArray(0);
-                c.glVertexAttribPointer(0, 2, c.GL_FLOAT, c.GL_FALSE, stride, null);
+        return self.last_gl_state_stats;
+    }
 
-                c.glEnableVertexAttribArray(1);
-                c.glVertexAttribPointer(1, 2, c.GL_FLOAT, c.GL_FALSE, stride, @ptrFromInt(2 * @sizeOf(f32)));
+    /// Draws, state changes, sprites, streamed bytes and CPU time of the most recently executed frame,
+    /// null before the first one. Safe to call from any thread.
+    pub fn getFrameStats(self: *Renderer) ?FrameStats {
+        return self.frame_stats_history.getLatest();
+    }
 
-                c.glDrawElements(c.GL_TRIANGLES, 6, c.GL_UNSIGNED_INT, null);
-            }
+    /// Copies stats of up to `buffer.len` most recent frames into `buffer`, oldest first.
+    /// At most `frame_stats_history_size` frames are kept. Safe to call from any thread.
+    pub fn getFrameStatsHistory(self: *Renderer, buffer: []FrameStats) []FrameStats {
+        return self.frame_stats_history.copyRecent(buffer);
+    }
 
-            game_objects.deinit(std.heap.c_allocator);
-            scene.active_game_objects_mutex.unlock();
-        }
+    /// Average and peak stats over up to `frame_count` most recent frames, e.g. to check scene against a budget
+    pub fn getFrameStatsSummary(self: *Renderer, frame_count: usize) FrameStatsSummary {
+        return self.frame_stats_history.summarize(frame_count);
+    }
 
-        try self.window.gl.context.swap_buffers(self.window.gl.context);
+    /// Writes a summary line every `interval` frames to `target`, `.None` stops it.
+    /// Same as setting `GLAZE_FRAME_STATS` and `GLAZE_FRAME_STATS_INTERVAL` before start.
+    pub fn setFrameStatsDump(self: *Renderer, target: FrameStatsDumpTarget, interval: usize) !void {
+        try self.frame_stats_history.setDump(target, interval);
+    }
+
+    /// Resident texture memory, evictions and reloads
+    pub fn getTextureStats(self: *Renderer) TextureStats {
+        return self.texture_manager.getStats();
+    }
+
+    /// GPU memory textures may use before unreferenced ones are evicted, applied on next frame
+    pub fn setTextureMemoryBudget(self: *Renderer, bytes: usize) void {
+        self.texture_manager.setMemoryBudget(bytes);
+    }
+
+    /// Builds and draws next frame even if nothing tracked changed, waking platform if it paused frames while idle.
+    /// Safe to call from any thread, does nothing before renderer was initialized.
+    pub fn requestRedraw() void {
+        const self = renderer_instance orelse return;
+        self.markDirty();
     }
 
     pub fn subscribeToRequestFrameEvent(callback: *const fn (void, ?*anyopaque) anyerror!void, data: ?*anyopaque) !void {
@@ -170,18 +349,112 @@ pub const Renderer = struct {
         _ = try renderer_instance.?.on_request_frame_event.addHandler(callback, data);
     }
 
+    /// Returns shared `TMaterial`, creating it on first use. Safe to call from any thread, program is linked when first drawn.
     pub fn cacheMaterial(TMaterial: type) !*TMaterial {
         if (renderer_instance == null)
             return error.RendererNotInitialized;
 
-        return renderer_instance.?.material_cache.getOrCreate(TMaterial, TMaterial.create);
+        const self = renderer_instance.?;
+        self.material_mutex.lock();
+        defer self.material_mutex.unlock();
+
+        return self.material_cache.getOrCreate(TMaterial, TMaterial.create);
+    }
+
+    /// Returns shared instance of `material` with `params`, equal parameters always return the same instance.
+    /// Safe to call from any thread.
+    pub fn cacheMaterialInstance(material: *Material, params: *const ParamBlock) !*MaterialInstance {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        const self = renderer_instance.?;
+        self.material_mutex.lock();
+        defer self.material_mutex.unlock();
+
+        return self.material_instances.getOrCreate(material, params);
+    }
+
+    /// Queues `TMaterial` and its shader variants to be created at the start of next frame, before anything is drawn with them.
+    /// Without it programs are compiled (or loaded from program binary cache) the first time a batch needs them, stalling that frame.
+    pub fn prewarmMaterial(comptime TMaterial: type) !void {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        const prewarm = struct {
+            fn run() anyerror!void {
+                const material = try cacheMaterial(TMaterial);
+                try material.material.prewarmVariants();
+            }
+        }.run;
+
+        const self = renderer_instance.?;
+        self.pending_prewarms_mutex.lock();
+        defer self.pending_prewarms_mutex.unlock();
+
+        try self.pending_prewarms.append(std.heap.c_allocator, prewarm);
+    }
+
+    /// Returns texture region, placeholder until it is uploaded. Loading and placeholder creation run on the render thread,
+    /// this blocks until it gets to them. Prefer `acquireTexture()` for sprites drawn every frame.
+    pub fn cacheTexture(path: []const u8) !TextureRegion {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        const Request = struct {
+            path: []const u8,
+            region: TextureRegion = TextureRegion.whole(0),
+
+            fn run(data: ?*anyopaque) anyerror!void {
+                const request = try Caster.castFromNullableAnyopaque(@This(), data);
+                request.region = try renderer_instance.?.texture_manager.getOrLoad(request.path);
+            }
+        };
+
+        var request = Request{ .path = path };
+        try renderer_instance.?.render_thread.invoke(Request.run, @ptrCast(&request));
+
+        return request.region;
+    }
+
+    /// Returns counted handle to texture, loaded in the background on first use. Safe to call from any thread.
+    pub fn acquireTexture(path: []const u8) !TextureHandle {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        return try renderer_instance.?.texture_manager.acquire(path);
+    }
+
+    /// Starts loading textures in the background so they are ready by the time sprites use them
+    pub fn prefetchTextures(paths: []const []const u8) !void {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        try renderer_instance.?.texture_manager.prefetch(paths);
     }
 
-    pub fn cacheTexture(path: []const u8) !c.GLuint {
+    /// Whether every texture in `paths` finished loading, can be polled from any thread
+    pub fn areTexturesReady(paths: []const []const u8) !bool {
         if (renderer_instance == null)
             return error.RendererNotInitialized;
 
-        return try renderer_instance.?.texture_manager.getOrLoad(path);
+        return renderer_instance.?.texture_manager.areReady(paths);
+    }
+
+    /// Blocks until every texture in `paths` is uploaded, e.g. from a request frame handler.
+    /// Uploads run on the render thread, the frame calling this is not recorded until they finish.
+    pub fn waitForTextures(paths: []const []const u8) !void {
+        if (renderer_instance == null)
+            return error.RendererNotInitialized;
+
+        const wait = struct {
+            fn run(data: ?*anyopaque) anyerror!void {
+                const waited_paths = try Caster.castFromNullableAnyopaque([]const []const u8, data);
+                try renderer_instance.?.texture_manager.waitFor(waited_paths.*);
+            }
+        }.run;
+
+        var waited_paths = paths;
+        try renderer_instance.?.render_thread.invoke(wait, @ptrCast(&waited_paths));
     }
 
     // DO NOT USE GL IN HERE IT IS EXECUTED ON THE MAIN FUCKING THREAD
@@ -201,22 +474,274 @@ pub const Renderer = struct {
         renderer.* = Renderer{
             .app = app,
             .window = window,
-            .vbo_handle = undefined,
-            .ebo_handle = undefined,
-            .vao_handle = undefined,
+            .sprite_batcher = SpriteBatcher.init(std.heap.c_allocator),
+            .sprite_instancer = SpriteInstancer.init(std.heap.c_allocator),
+            .render_queue = RenderQueue.init(std.heap.c_allocator),
+            .frame_constants = FrameConstantsBuffer.init(),
+            .stream_buffer = StreamBuffer.init(stream_region_size),
+            .start_timestamp = std.time.nanoTimestamp(),
+            .last_frame_timestamp = std.time.nanoTimestamp(),
             .on_request_frame_event = event,
             .material_cache = material_cache,
+            .material_instances = MaterialInstanceCache.init(),
             .texture_manager = TextureManager.init(),
+            .frame_stats_history = FrameStatsHistory.init(),
+            .idle_mode = options.idle_mode,
+            .render_thread = RenderThread.init(std.heap.c_allocator, executeCommandList, renderer),
         };
 
+        // Uploads only happen while frames are drawn, idle renderer would never pick decoded textures up otherwise
+        renderer.texture_manager.setOnDecoded(onTextureDecoded, renderer);
+
         _ = try window.on_request_frame.addHandler(onRequestFrame, renderer);
         renderer_instance = renderer;
         return renderer;
     }
 
+    /// Waits for frames in flight to be presented and stops render thread, frames submitted afterwards are dropped.
+    /// Call before reading what the render thread wrote or exiting the process. Frame thread only.
+    pub fn stopRenderThread(self: *Renderer) void {
+        self.render_thread.stop();
+    }
+
     pub fn deinit(self: *Renderer) void {
+        // Context has to be released by the render thread before window destroys it
+        self.render_thread.stop();
         self.window.deinit();
     }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    /// Creates materials queued by `prewarmMaterial()`, failures are logged and the material is created again on first use
+    fn runPrewarms(self: *Renderer) void {
+        self.pending_prewarms_mutex.lock();
+        defer self.pending_prewarms_mutex.unlock();
+
+        for (self.pending_prewarms.items) |prewarm| {
+            prewarm() catch |e| std.log.err("Failed to prewarm material: {}", .{e});
+        }
+        self.pending_prewarms.clearRetainingCapacity();
+    }
+
+    /// Called on a texture decode worker
+    fn onTextureDecoded(data: ?*anyopaque) void {
+        const self = Caster.castFromNullableAnyopaque(Renderer, data) catch return;
+        self.markDirty();
+    }
+
+    fn markDirty(self: *Renderer) void {
+        self.needs_redraw.store(true, .seq_cst);
+        if (self.window.is_idle.load(.seq_cst)) self.window.wake();
+    }
+
+    /// Whether frame has to be built, taking pending changes. Marks window idle when frames may be paused instead.
+    /// Frame thread only.
+    fn consumeRedraw(self: *Renderer) bool {
+        const is_resized = self.window.width != self.built_width or self.window.height != self.built_height;
+        self.built_width = self.window.width;
+        self.built_height = self.window.height;
+
+        if (self.needs_redraw.swap(false, .seq_cst) or is_resized or self.idle_mode == .Off) {
+            self.window.is_idle.store(false, .seq_cst);
+            return true;
+        }
+
+        // Skipping a frame would stall platforms that only get the next one after presenting, they pause instead
+        const must_pause = !self.window.can_skip_frames;
+        if (self.idle_mode != .PauseFrames and !must_pause) return false;
+
+        const can_pause = self.window.on_wake != null;
+        if (must_pause and !can_pause) return true;
+
+        // Timers only advance with frames, pausing would stop them from ever firing
+        if (self.app.event_system.hasPendingTimers()) {
+            self.window.is_idle.store(false, .seq_cst);
+            return must_pause;
+        }
+
+        // `markDirty()` stores before checking idle, so a change made meanwhile is either seen here or wakes the window
+        self.window.is_idle.store(true, .seq_cst);
+        if (!self.needs_redraw.swap(false, .seq_cst)) return false;
+
+        self.window.is_idle.store(false, .seq_cst);
+        return true;
+    }
+
+    /// Returns path this frame is drawn with, never `Auto`
+    fn resolveSpritePath(self: *Renderer, scene_key: usize, sprite_count: usize) SpritePath {
+        self.sprite_path_mutex.lock();
+        defer self.sprite_path_mutex.unlock();
+
+        const path = switch (self.sprite_path) {
+            .Auto => blk: {
+                self.sprite_path_selector.observeScene(scene_key, sprite_count);
+                break :blk self.sprite_path_selector.next();
+            },
+            else => self.sprite_path,
+        };
+
+        if (path == .Instanced and !SpriteInstancer.isSupported()) {
+            if (self.sprite_path == .Auto) self.sprite_path_selector.choose(.Batched);
+            return .Batched;
+        }
+
+        // Only the scene that failed to draw instanced falls back, others keep using the selected path
+        if (path == .Instanced and self.batched_scene_key == scene_key) {
+            if (self.sprite_path == .Auto) self.sprite_path_selector.choose(.Batched);
+            return .Batched;
+        }
+
+        return path;
+    }
+
+    /// Makes `Auto` settle on batched sprites, other paths are left alone
+    fn chooseBatchedPath(self: *Renderer) void {
+        self.sprite_path_mutex.lock();
+        defer self.sprite_path_mutex.unlock();
+
+        if (self.sprite_path == .Auto) self.sprite_path_selector.choose(.Batched);
+    }
+
+    /// Build stage: records camera, timing and every sprite of active scene that is in view into `list`.
+    /// Scene lock is only held while copying, so submission of the previous frame and scene updates do not wait on each other.
+    fn buildCommandList(self: *Renderer, list: *CommandList) !void {
+        list.clear();
+        list.width = self.window.width;
+        list.height = self.window.height;
+
+        const now = std.time.nanoTimestamp();
+        const time: f32 = @floatCast(@as(f64, @floatFromInt(now - self.start_timestamp)) / std.time.ns_per_s);
+        const delta: f32 = @floatCast(@as(f64, @floatFromInt(now - self.last_frame_timestamp)) / std.time.ns_per_s);
+        self.last_frame_timestamp = now;
+
+        const scene = self.app.scene_manager.getActiveScene() catch return;
+        const camera_object = scene.camera orelse return;
+
+        // We need to obtain lock on active game objects to prevent invalid game objects access
+        scene.active_game_objects_mutex.lock();
+        defer scene.active_game_objects_mutex.unlock();
+
+        const proj_matrix = makeOrthoProjectionMatrix(@floatFromInt(list.width), @floatFromInt(list.height));
+
+        const camera = camera_object.getComponent(Camera2D) orelse return error.InvalidCamera;
+        const view_matrix = camera.makeViewMatrix();
+
+        // View and projection are combined once here instead of per vertex
+        const view_projection = multiplyMatrices(&proj_matrix, &view_matrix);
+        const viewport = [4]f32{ 0.0, 0.0, @floatFromInt(list.width), @floatFromInt(list.height) };
+
+        var object_count: usize = 0;
+        for (scene.active_game_objects.items) |obj| {
+            if (!obj.is_active) continue;
+            object_count += 1;
+
+            const transform = obj.getComponent(Transform) orelse continue;
+            const renderer = obj.getComponent(SpriteRenderer) orelse continue;
+
+            const model_matrix = transform.get2DMatrix();
+            if (!isInView(&view_projection, &model_matrix)) {
+                list.culled_count += 1;
+                continue;
+            }
+
+            const material = try renderer.getMaterial();
+
+            // List holds its own reference, sprite may drop its texture before the render thread gets to it
+            const texture = if (renderer.texture) |handle| handle.clone() else null;
+            errdefer if (texture) |handle| handle.release();
+
+            try list.addSprite(SpriteCommand{
+                .material = material,
+                .texture = texture,
+                .model_matrix = model_matrix,
+                .color = renderer.color,
+                .screen_size = if (texture != null) getScreenSize(&view_projection, &model_matrix, viewport) else 0.0,
+                .depth = transform.position.z,
+                .layer = renderer.layer,
+            });
+        }
+
+        list.view = .{
+            .view_projection = view_projection,
+            .viewport = viewport,
+            .time = time,
+            .delta = delta,
+            .scene_key = @intFromPtr(scene),
+            .object_count = object_count,
+        };
+    }
+
+    /// Resolves textures of recorded sprites, submits them into render queue and sorts it.
+    /// Also reports on-screen size of every textured sprite so texture residency can follow it.
+    fn buildRenderQueue(self: *Renderer, sprites: []const SpriteCommand) !void {
+        self.render_queue.clear();
+
+        for (sprites) |sprite| {
+            var region = TextureRegion.whole(0);
+
+            if (sprite.texture) |handle| {
+                self.texture_manager.noteUsage(handle, sprite.screen_size);
+                region = self.texture_manager.resolve(handle);
+            }
+
+            const draw = SpriteDraw{
+                .material = sprite.material,
+                .region = region,
+                .model_matrix = sprite.model_matrix,
+                .color = sprite.color,
+            };
+
+            const is_texture_translucent = if (sprite.texture) |handle| handle.isTranslucent() else false;
+            const is_translucent = draw.color[3] < 1.0 or draw.material.is_translucent or is_texture_translucent;
+            const key = makeSortKey(sprite.layer, is_translucent, draw.material.id, draw.region.texture, sprite.depth);
+
+            try self.render_queue.submit(key, draw);
+        }
+
+        try self.render_queue.sort();
+    }
+
+    /// Longest side in pixels of the unit quad transformed by `model_matrix`
+    fn getScreenSize(view_projection: *const [16]f32, model_matrix: *const [16]f32, viewport: [4]f32) f32 {
+        const vp = view_projection;
+        const m = model_matrix;
+
+        // Only the 2D axes of the quad matter, translation does not change its size
+        const x_axis = [2]f32{ (vp[0] * m[0] + vp[4] * m[1]) * viewport[2] * 0.5, (vp[1] * m[0] + vp[5] * m[1]) * viewport[3] * 0.5 };
+        const y_axis = [2]f32{ (vp[0] * m[4] + vp[4] * m[5]) * viewport[2] * 0.5, (vp[1] * m[4] + vp[5] * m[5]) * viewport[3] * 0.5 };
+
+        return @max(@sqrt(x_axis[0] * x_axis[0] + x_axis[1] * x_axis[1]), @sqrt(y_axis[0] * y_axis[0] + y_axis[1] * y_axis[1]));
+    }
+
+    /// Whether unit quad transformed by `model_matrix` overlaps clip space, expects 2D transforms like `getScreenSize()`
+    fn isInView(view_projection: *const [16]f32, model_matrix: *const [16]f32) bool {
+        const vp = view_projection;
+        const m = model_matrix;
+
+        // Bounding box of the quad in clip space, corners are half a unit away from its center on both axes
+        const center_x = vp[0] * m[12] + vp[4] * m[13] + vp[8] * m[14] + vp[12];
+        const center_y = vp[1] * m[12] + vp[5] * m[13] + vp[9] * m[14] + vp[13];
+        const extent_x = (@abs(vp[0] * m[0] + vp[4] * m[1]) + @abs(vp[0] * m[4] + vp[4] * m[5])) * 0.5;
+        const extent_y = (@abs(vp[1] * m[0] + vp[5] * m[1]) + @abs(vp[1] * m[4] + vp[5] * m[5])) * 0.5;
+
+        return center_x + extent_x >= -1.0 and center_x - extent_x <= 1.0 and
+            center_y + extent_y >= -1.0 and center_y - extent_y <= 1.0;
+    }
+
+    /// Feeds sorted render queue to `submitter`, either `SpriteBatcher` or `SpriteInstancer`
+    ///
+    /// # Returns
+    /// Number of batches sprites were drawn in
+    fn submitSprites(self: *Renderer, submitter: anytype) !usize {
+        submitter.begin();
+
+        for (self.render_queue.getSorted()) |item| {
+            const draw = self.render_queue.getDraw(item);
+            try submitter.drawSprite(draw.material, draw.region, &draw.model_matrix, &draw.color);
+        }
+
+        try submitter.end(&self.frame_constants, &self.stream_buffer);
+        return submitter.getDrawCallCount();
+    }
 };
 
 fn VerifyPlatformRenderer(comptime renderer: type) type {
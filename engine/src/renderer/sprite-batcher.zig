@@ -0,0 +1,234 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const MaterialInstance = @import("../materials/material-instance.zig").MaterialInstance;
+const sprite_shader = @import("../materials/sprite-shader.zig");
+const ShaderFeatures = sprite_shader.ShaderFeatures;
+const Attributes = sprite_shader.BatchedAttributes;
+const TextureRegion = @import("../textures/texture-manager.zig").TextureRegion;
+const GlState = @import("gl/gl-state.zig").GlState;
+const FrameConstantsBuffer = @import("gl/frame-constants.zig").FrameConstantsBuffer;
+const StreamBuffer = @import("gl/stream-buffer.zig").StreamBuffer;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Vertex layout every sprite material has to accept.
+/// Positions are already in world space, so materials only apply view and projection.
+pub const SpriteVertex = extern struct {
+    x: f32,
+    y: f32,
+    u: f32,
+    v: f32,
+    r: f32,
+    g: f32,
+    b: f32,
+    a: f32,
+};
+
+const vertices_per_sprite = 4;
+const indices_per_sprite = 6;
+const min_index_capacity = 1024;
+
+// Unit quad centered on origin: x, y, u, v
+const quad_corners = [vertices_per_sprite][4]f32{
+    .{ -0.5, 0.5, 0.0, 1.0 }, // top-left
+    .{ -0.5, -0.5, 0.0, 0.0 }, // bottom-left
+    .{ 0.5, -0.5, 1.0, 0.0 }, // bottom-right
+    .{ 0.5, 0.5, 1.0, 1.0 }, // top-right
+};
+
+/// Run of consecutive sprites that share material and texture and are drawn with a single call
+const Batch = struct {
+    material: *MaterialInstance,
+    texture: c.GLuint,
+    first_sprite: usize,
+    sprite_count: usize,
+    has_vertex_color: bool, // Any sprite is not white, otherwise batch is drawn without vertex color
+};
+
+/// Collects sprites for a frame, expands them into quads on the CPU and draws them from the renderer's stream buffer.
+/// A new draw call is only issued when material instance or texture changes between consecutive sprites.
+pub const SpriteBatcher = struct {
+    allocator: Allocator,
+
+    vertices: ArrayList(SpriteVertex),
+    batches: ArrayList(Batch),
+
+    ebo_handle: c.GLuint,
+    index_capacity: usize, // Number of sprites index buffer can draw with a single call
+    are_buffers_initialized: bool,
+
+    last_draw_call_count: usize,
+    last_sprite_count: usize,
+
+    pub fn init(allocator: Allocator) SpriteBatcher {
+        return SpriteBatcher{
+            .allocator = allocator,
+            .vertices = ArrayList(SpriteVertex){},
+            .batches = ArrayList(Batch){},
+            .ebo_handle = 0,
+            .index_capacity = 0,
+            .are_buffers_initialized = false,
+            .last_draw_call_count = 0,
+            .last_sprite_count = 0,
+        };
+    }
+
+    /// Frees CPU side buffers and GL buffers. Must be called on the thread that owns GL context.
+    pub fn deinit(self: *SpriteBatcher) void {
+        if (self.are_buffers_initialized) GlState.get().deleteBuffer(self.ebo_handle);
+
+        self.vertices.deinit(self.allocator);
+        self.batches.deinit(self.allocator);
+    }
+
+    /// Starts collecting sprites for a new frame
+    pub fn begin(self: *SpriteBatcher) void {
+        self.vertices.clearRetainingCapacity();
+        self.batches.clearRetainingCapacity();
+    }
+
+    /// Adds sprite to current frame
+    ///
+    /// # Arguments
+    /// - `material`: Material instance sprite is drawn with
+    /// - `region`: Texture and UV rect of the sprite, texture 0 for none
+    /// - `model_matrix`: Transform of the unit quad, see `Transform.get2DMatrix()`
+    /// - `color`: Color multiplied with texture
+    pub fn drawSprite(self: *SpriteBatcher, material: *MaterialInstance, region: TextureRegion, model_matrix: *const [16]f32, color: *const [4]f32) !void {
+        const sprite_index = self.vertices.items.len / vertices_per_sprite;
+
+        const continues_batch = if (self.batches.items.len > 0) blk: {
+            const last = self.batches.items[self.batches.items.len - 1];
+            break :blk last.material == material and last.texture == region.texture;
+        } else false;
+
+        if (!continues_batch) {
+            try self.batches.append(self.allocator, Batch{
+                .material = material,
+                .texture = region.texture,
+                .first_sprite = sprite_index,
+                .sprite_count = 0,
+                .has_vertex_color = false,
+            });
+        }
+
+        const uv = region.uv_rect;
+
+        const vertices = try self.vertices.addManyAsArray(self.allocator, vertices_per_sprite);
+        for (quad_corners, 0..) |corner, i| {
+            vertices[i] = SpriteVertex{
+                .x = model_matrix[0] * corner[0] + model_matrix[4] * corner[1] + model_matrix[12],
+                .y = model_matrix[1] * corner[0] + model_matrix[5] * corner[1] + model_matrix[13],
+                .u = uv[0] + (uv[2] - uv[0]) * corner[2],
+                .v = uv[1] + (uv[3] - uv[1]) * corner[3],
+                .r = color[0],
+                .g = color[1],
+                .b = color[2],
+                .a = color[3],
+            };
+        }
+
+        const batch = &self.batches.items[self.batches.items.len - 1];
+        batch.sprite_count += 1;
+        batch.has_vertex_color = batch.has_vertex_color or !sprite_shader.isWhite(color);
+    }
+
+    /// Streams every sprite collected since `begin()` in a single write and draws all batches
+    ///
+    /// # Arguments
+    /// - `frame_constants`: Constants of the frame, applied to every program used
+    /// - `stream_buffer`: Buffer vertices are streamed through, its frame has to be begun
+    pub fn end(self: *SpriteBatcher, frame_constants: *FrameConstantsBuffer, stream_buffer: *StreamBuffer) !void {
+        self.last_draw_call_count = 0;
+        self.last_sprite_count = self.vertices.items.len / vertices_per_sprite;
+
+        if (self.batches.items.len == 0) return;
+
+        if (!self.are_buffers_initialized) {
+            self.ebo_handle = GlState.get().createBuffer();
+            self.are_buffers_initialized = true;
+        }
+
+        const allocation = stream_buffer.write(std.mem.sliceAsBytes(self.vertices.items), @alignOf(SpriteVertex));
+
+        var largest_batch: usize = 0;
+        for (self.batches.items) |batch| largest_batch = @max(largest_batch, batch.sprite_count);
+        try self.ensureIndexCapacity(largest_batch);
+
+        const gl_state = GlState.get();
+        gl_state.bindArrayBuffer(allocation.buffer);
+        gl_state.bindElementArrayBuffer(self.ebo_handle);
+
+        gl_state.enableAttribute(Attributes.position);
+        gl_state.enableAttribute(Attributes.tex_coord);
+        gl_state.enableAttribute(Attributes.color);
+
+        for (self.batches.items) |batch| {
+            // Cheapest variant that still draws the batch correctly
+            const features = ShaderFeatures{ .textured = batch.texture != 0, .vertex_color = batch.has_vertex_color };
+            const material = try batch.material.material.selectVariant(features);
+
+            _ = try batch.material.bind(material);
+            frame_constants.apply(&material.frame_uniforms);
+
+            gl_state.bindTexture2D(0, batch.texture);
+
+            // Attribute pointers start at the batch so the same index buffer works for every batch
+            setVertexAttributes(gl_state, allocation.offset + batch.first_sprite * vertices_per_sprite * @sizeOf(SpriteVertex));
+
+            gl_state.drawTriangles(batch.sprite_count * indices_per_sprite);
+            self.last_draw_call_count += 1;
+        }
+    }
+
+    /// Number of draw calls issued by last `end()`
+    pub fn getDrawCallCount(self: *const SpriteBatcher) usize {
+        return self.last_draw_call_count;
+    }
+
+    /// Number of sprites drawn by last `end()`
+    pub fn getSpriteCount(self: *const SpriteBatcher) usize {
+        return self.last_sprite_count;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn ensureIndexCapacity(self: *SpriteBatcher, sprite_count: usize) !void {
+        if (sprite_count <= self.index_capacity) return;
+
+        const capacity = @max(sprite_count, self.index_capacity * 2, min_index_capacity);
+
+        const indices = try self.allocator.alloc(u32, capacity * indices_per_sprite);
+        defer self.allocator.free(indices);
+
+        for (0..capacity) |sprite| {
+            const first: u32 = @intCast(sprite * vertices_per_sprite);
+            const index = sprite * indices_per_sprite;
+
+            indices[index + 0] = first + 0;
+            indices[index + 1] = first + 1;
+            indices[index + 2] = first + 2;
+            indices[index + 3] = first + 2;
+            indices[index + 4] = first + 3;
+            indices[index + 5] = first + 0;
+        }
+
+        const gl_state = GlState.get();
+        gl_state.bindElementArrayBuffer(self.ebo_handle);
+        gl_state.bufferData(c.GL_ELEMENT_ARRAY_BUFFER, std.mem.sliceAsBytes(indices), c.GL_STATIC_DRAW);
+
+        self.index_capacity = capacity;
+    }
+
+    fn setVertexAttributes(gl_state: *GlState, offset: usize) void {
+        const stride = @sizeOf(SpriteVertex);
+
+        gl_state.setAttributePointer(Attributes.position, .{ .size = 2, .stride = stride, .offset = offset + @offsetOf(SpriteVertex, "x") });
+        gl_state.setAttributePointer(Attributes.tex_coord, .{ .size = 2, .stride = stride, .offset = offset + @offsetOf(SpriteVertex, "u") });
+        gl_state.setAttributePointer(Attributes.color, .{ .size = 4, .stride = stride, .offset = offset + @offsetOf(SpriteVertex, "r") });
+    }
+};
@@ -0,0 +1,88 @@
+const std = @import("std");
+
+/// How sprites are submitted to the GPU
+pub const SpritePath = enum {
+    /// Measure GPU time of both paths on the current scene and keep the faster one
+    Auto,
+    /// Quads expanded on the CPU into one streaming vertex buffer, see `SpriteBatcher`
+    Batched,
+    /// Static quad drawn with per instance attributes, see `SpriteInstancer`
+    Instanced,
+};
+
+// Frames measured per path before choosing, first few of each run are skipped as warm up
+const samples_per_path = 60;
+const warmup_frames = 5;
+
+/// Picks faster sprite path for the current scene by timing a few frames of each on the GPU.
+/// Measurement restarts whenever scene changes or its sprite count changes by more than 2x.
+pub const SpritePathSelector = struct {
+    chosen: ?SpritePath = null,
+    measured_frames: [2]u32 = .{ 0, 0 },
+    total_ns: [2]u64 = .{ 0, 0 },
+
+    scene_key: usize = 0,
+    sprite_count: usize = 0,
+
+    /// Resets measurement when scene differs from the one that was measured
+    ///
+    /// # Arguments
+    /// - `scene_key`: Anything that identifies active scene, e.g. its address
+    /// - `sprite_count`: Number of sprites in the frame about to be drawn
+    pub fn observeScene(self: *SpritePathSelector, scene_key: usize, sprite_count: usize) void {
+        const grew = sprite_count > self.sprite_count * 2;
+        const shrunk = sprite_count * 2 < self.sprite_count;
+
+        if (scene_key != self.scene_key or grew or shrunk) {
+            self.* = SpritePathSelector{
+                .scene_key = scene_key,
+                .sprite_count = sprite_count,
+            };
+        }
+    }
+
+    /// Path next frame should be drawn with, never `Auto`
+    pub fn next(self: *const SpritePathSelector) SpritePath {
+        if (self.chosen) |path| return path;
+
+        return if (self.measured_frames[0] < samples_per_path + warmup_frames) .Batched else .Instanced;
+    }
+
+    /// Adds GPU time `path` took to draw a frame's sprites, chooses path once both are measured
+    pub fn record(self: *SpritePathSelector, path: SpritePath, ns: u64) void {
+        if (self.chosen != null) return;
+
+        const index = pathIndex(path) orelse return;
+
+        // GPU results arrive a few frames late, so a path may be drawn a little longer than it is measured
+        self.measured_frames[index] += 1;
+        const frame = self.measured_frames[index];
+        if (frame > warmup_frames and frame <= warmup_frames + samples_per_path) self.total_ns[index] += ns;
+
+        if (self.measured_frames[1] < samples_per_path + warmup_frames) return;
+
+        const batched_mean = self.total_ns[0] / samples_per_path;
+        const instanced_mean = self.total_ns[1] / samples_per_path;
+
+        self.chosen = if (instanced_mean < batched_mean) .Instanced else .Batched;
+        std.log.info("Sprite path: batched {}us, instanced {}us, using {s}", .{
+            batched_mean / std.time.ns_per_us,
+            instanced_mean / std.time.ns_per_us,
+            @tagName(self.chosen.?),
+        });
+    }
+
+    /// Forces path without measuring, used when one of them is not available
+    pub fn choose(self: *SpritePathSelector, path: SpritePath) void {
+        self.chosen = path;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn pathIndex(path: SpritePath) ?usize {
+        return switch (path) {
+            .Batched => 0,
+            .Instanced => 1,
+            .Auto => null,
+        };
+    }
+};
@@ -9,8 +9,23 @@ pub const Window = struct {
     width: i32,
     height: i32,
 
+    // Set by renderer while nothing changed since the last drawn frame and its idle mode allows pausing.
+    // Platforms that support it stop requesting frames meanwhile until `wake()` is called.
+    is_idle: std.atomic.Value(bool) = .init(false),
+    on_wake: ?*const fn (data: ?*anyopaque) void = null, // Resumes paused frames, safe to call from any thread. Null if platform never pauses.
+    wake_data: ?*anyopaque = null,
+
+    // False when platform only gets its next frame after presenting one, e.g. Wayland frame callbacks.
+    // Renderer then pauses frames instead of skipping them, or draws every frame when platform cannot pause.
+    can_skip_frames: bool = true,
+
     pub fn deinit(self: *Window) void {
         self.gl.destroy();
         self.on_request_frame.deinit();
     }
+
+    /// Resumes requesting frames if platform paused them while idle
+    pub fn wake(self: *Window) void {
+        if (self.on_wake) |on_wake| on_wake(self.wake_data);
+    }
 };
@@ -17,25 +17,30 @@ pub fn main() !void {
     const app = try App.create();
     Debug.toggleFpsLogging();
 
+    // Compile sprite shaders before the first sprite needs them
+    try Renderer.prewarmMaterial(StandardMaterial);
+
     //#region test scene
     const scene = try app.scene_manager.createScene("scene-1");
     try app.scene_manager.setActiveScene("scene-1");
     const go = try scene.addGameObject();
     _ = try go.addComponent(Transform);
-    _ = try go.addComponent(SpriteRenderer("src/assets/textures/logo.png"));
+    _ = try go.addComponent(SpriteRenderer);
 
     const transform = go.getComponent(Transform) orelse unreachable;
     transform.scale.setScalar(2);
 
-    const renderer = go.getComponent(SpriteRenderer("")) orelse unreachable;
+    const renderer = go.getComponent(SpriteRenderer) orelse unreachable;
+    try renderer.setTexture("src/assets/textures/logo.png");
     var newColor = Vector4.fromXYZW(1, 1, 0, 0.5);
     renderer.setColor(&newColor);
 
     const go2 = try scene.addGameObject();
     _ = try go2.addComponent(Transform);
-    _ = try go2.addComponent(SpriteRenderer("src/assets/textures/circle.png"));
+    _ = try go2.addComponent(SpriteRenderer);
 
-    const renderer2 = go2.getComponent(SpriteRenderer("")) orelse unreachable;
+    const renderer2 = go2.getComponent(SpriteRenderer) orelse unreachable;
+    try renderer2.setTexture("src/assets/textures/circle.png");
     var newColor2 = Vector4.fromXYZW(1, 1, 0, 1);
     renderer2.setColor(&newColor2);
 
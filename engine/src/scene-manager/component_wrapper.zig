@@ -27,6 +27,7 @@ pub const ComponentWrapper = struct {
     component: *anyopaque, // Underlying component
     component_size: usize, // Used to free up raw allocated memory of underlying component
     component_alignment: std.mem.Alignment, // Used to free up raw allocated memory of underlying component
+    component_name: []const u8, // Type name of underlying component, identifies its handlers in profiler reports
 
     render_events: *RenderEvents,
     game_object: *GameObject,
@@ -97,6 +98,7 @@ pub const ComponentWrapper = struct {
             .component = comp,
             .component_size = component_size,
             .component_alignment = component_alignment,
+            .component_name = @typeName(TComponent),
             .render_events = App.get().event_system.render_events,
             .game_object = game_object,
             .is_active = true,
@@ -151,10 +153,10 @@ pub const ComponentWrapper = struct {
     //#region Event binding
     fn bindRenderEvents(self: *Self) !void {
         if (self.fn_update) |fn_update|
-            self.events_id[0] = try self.render_events.registerOnUpdate(fn_update, self.component);
+            self.events_id[0] = try self.render_events.registerNamedOnUpdate(fn_update, self.component, self.component_name);
 
         if (self.fn_post_render) |fn_post_render|
-            self.events_id[1] = try self.render_events.registerOnPostRender(fn_post_render, self.component);
+            self.events_id[1] = try self.render_events.registerNamedOnPostRender(fn_post_render, self.component, self.component_name);
     }
 
     fn unbindRenderEvents(self: *Self) !void {
@@ -8,6 +8,7 @@ const cAlloc = c_allocator_util.cAlloc;
 const cFree = c_allocator_util.cFree;
 
 const App = @import("../app.zig").App;
+const Renderer = @import("../renderer/renderer.zig").Renderer;
 const ComponentWrapper = @import("./component_wrapper.zig").ComponentWrapper;
 const DynString = @import("../utils/dyn_string.zig").DynString;
 const InputSystem = @import("../input-system/input.zig").InputSystem;
@@ -187,6 +188,7 @@ pub const GameObject = struct {
         if (self.is_active == is_active) return;
 
         self.is_active = is_active;
+        Renderer.requestRedraw();
 
         var it = self.components.iterator();
         while (it.next()) |entry| {
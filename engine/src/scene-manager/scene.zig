@@ -9,6 +9,7 @@ const cAlloc = c_allocator_util.cAlloc;
 const cFree = c_allocator_util.cFree;
 
 const App = @import("../app.zig").App;
+const Renderer = @import("../renderer/renderer.zig").Renderer;
 const GameObject = @import("game_object.zig").GameObject;
 
 pub const Scene = struct {
@@ -147,12 +148,15 @@ pub const Scene = struct {
         self.queued_game_objects_mutex.lock();
         defer self.queued_game_objects_mutex.unlock();
 
+        if (self.queued_game_objects.items.len == 0) return;
+
         // Move queued game objects to active game objects
         self.active_game_objects.appendSlice(self.arena_allocator.allocator(), self.queued_game_objects.items) catch {
             std.log.err("Failed to append game objects to active game objects", .{});
         };
 
         self.queued_game_objects.clearRetainingCapacity();
+        Renderer.requestRedraw();
     }
 
     /// Frees all inactive game objects
@@ -179,6 +183,7 @@ pub const Scene = struct {
 
     pub fn makeCameraCurrent(self: *Scene, camera: *GameObject) void {
         self.camera = camera;
+        Renderer.requestRedraw();
     }
 
     //#region Remove functions
@@ -283,6 +288,7 @@ pub const Scene = struct {
         if (self.active_game_objects.items.len > 0) {
             for (self.active_game_objects.items, 0..) |item, index| {
                 if (filter_fn(item, option)) {
+                    Renderer.requestRedraw();
                     return self.active_game_objects.swapRemove(index);
                 }
             }
@@ -5,6 +5,7 @@ const allocateNewArena = arena_allocator_util.allocateNewArena;
 const freeArenaWithPageAllocator = arena_allocator_util.freeArenaWithPageAllocator;
 
 const App = @import("../app.zig").App;
+const Renderer = @import("../renderer/renderer.zig").Renderer;
 const Scene = @import("./scene.zig").Scene;
 
 pub const SceneManager = struct {
@@ -125,6 +126,7 @@ pub const SceneManager = struct {
         // Set active scene and call load on it
         if (self.findScene(name)) |scene| {
             self.active_scene = scene;
+            Renderer.requestRedraw();
             scene.load() catch return SceneManagerError.FailedToLoadActiveScene;
         } else return SceneManagerError.SceneDoesNotExist;
     }
@@ -8,6 +8,7 @@ const Debug = @import("debug/debug.zig").Debug;
 const Scene = @import("scene-manager/scene.zig").Scene;
 const DynString = @import("utils/dyn_string.zig").DynString;
 const Transform = @import("components/transform.zig").Transform;
+const Vector3 = @import("vectors/vector3.zig").Vector3;
 const Square = @import("scene-manager/objects/square.zig").Square;
 const KeyCode = @import("input-system/keycode/keycode.zig").KeyCode;
 const GameObject = @import("scene-manager/game_object.zig").GameObject;
@@ -35,72 +36,92 @@ pub fn setup(app: *App) !void {
         _ = try go2.addComponent(Player1Script);
     }
 
-    _ = try app.event_system.window_events.registerOnKeyDown(onDeleteScene, scene_manager);
+    const window_events = app.event_system.window_events;
+    _ = try window_events.registerOnKeyDownFor(.Delete, onDeleteAllEntities, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.Insert, onCreateEntities, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F1, onActivateFirstScene, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F2, onActivateSecondScene, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F3, onRemoveFirstEntities, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F4, onRemovePlayer, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F5, onDestroyFirstScene, scene_manager);
+    _ = try window_events.registerOnKeyDownFor(.F6, onPauseEntities, scene_manager);
 
     while (true) {
         std.Thread.sleep(2 * std.time.ns_per_week);
     }
 }
 
-fn onDeleteScene(key: KeyCode, data: ?*anyopaque) anyerror!void {
+// Delete -> Delete all entities
+fn onDeleteAllEntities(_: KeyCode, data: ?*anyopaque) anyerror!void {
     const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    const scene = try scene_manager.getActiveScene();
 
-    // Delete -> Delete all entities
-    if (key == .Delete) {
-        const scene = try scene_manager.getActiveScene();
-
-        for (0..size) |i| {
-            try scene.removeGameObjectById(i);
-        }
-    }
-    // Insert -> Create new entities
-    else if (key == .Insert) {
-        std.debug.print("Pressed", .{});
-        const scene = try scene_manager.getActiveScene();
-
-        for (0..size) |_| {
-            // std.debug.print("Index: {}", .{i});
-            const go2 = try scene.addGameObject();
-            //go2.name = "player1";
-            _ = try go2.addComponent(Transform);
-            _ = try go2.addComponent(SpriteRenderer);
-            _ = try go2.addComponent(Player1Script);
-        }
-    }
-    // F1 -> Sets active scene to 'scene1'
-    else if (key == .F1) {
-        try scene_manager.setActiveScene("scene-1");
+    for (0..size) |i| {
+        try scene.removeGameObjectById(i);
     }
-    // F2 -> Sets active scene to 'scene2'
-    else if (key == .F2) {
-        try scene_manager.setActiveScene("scene2");
-    }
-    // F3 -> Remove first 10 elements
-    else if (key == .F3) {
-        const scene = try scene_manager.getActiveScene();
+}
 
-        for (0..10) |i| {
-            try scene.removeGameObjectById(i);
-        }
-    }
-    // F4 -> Remove game object by name 'player1'
-    else if (key == .F4) {
-        const scene = try scene_manager.getActiveScene();
-        try scene.removeGameObjectByName("player1");
+// Insert -> Create new entities
+fn onCreateEntities(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+
+    std.debug.print("Pressed", .{});
+    const scene = try scene_manager.getActiveScene();
+
+    for (0..size) |_| {
+        // std.debug.print("Index: {}", .{i});
+        const go2 = try scene.addGameObject();
+        //go2.name = "player1";
+        _ = try go2.addComponent(Transform);
+        _ = try go2.addComponent(SpriteRenderer);
+        _ = try go2.addComponent(Player1Script);
     }
-    // F5 -> Destroy scene 'scene1'
-    else if (key == .F5) {
-        try scene_manager.setActiveScene("scene2");
-        try scene_manager.removeScene("scene-1");
+}
+
+// F1 -> Sets active scene to 'scene1'
+fn onActivateFirstScene(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    try scene_manager.setActiveScene("scene-1");
+}
+
+// F2 -> Sets active scene to 'scene2'
+fn onActivateSecondScene(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    try scene_manager.setActiveScene("scene2");
+}
+
+// F3 -> Remove first 10 elements
+fn onRemoveFirstEntities(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    const scene = try scene_manager.getActiveScene();
+
+    for (0..10) |i| {
+        try scene.removeGameObjectById(i);
     }
-    // F6 -> Pause all game objects
-    else if (key == .F6) {
-        const scene = try scene_manager.getActiveScene();
+}
 
-        for (0..size) |i| {
-            const a = scene.getGameObjectById(i);
-            a.?.setActive(false);
-        }
+// F4 -> Remove game object by name 'player1'
+fn onRemovePlayer(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    const scene = try scene_manager.getActiveScene();
+    try scene.removeGameObjectByName("player1");
+}
+
+// F5 -> Destroy scene 'scene1'
+fn onDestroyFirstScene(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    try scene_manager.setActiveScene("scene2");
+    try scene_manager.removeScene("scene-1");
+}
+
+// F6 -> Pause all game objects
+fn onPauseEntities(_: KeyCode, data: ?*anyopaque) anyerror!void {
+    const scene_manager = try caster.castFromNullableAnyopaque(SceneManager, data);
+    const scene = try scene_manager.getActiveScene();
+
+    for (0..size) |i| {
+        const a = scene.getGameObjectById(i);
+        a.?.setActive(false);
     }
 }
 
@@ -133,15 +154,17 @@ const Player1Script = struct {
 
             const speed: f32 = 2.0;
 
-            transform.position.x += dx * speed * delta_s;
-            transform.position.y += dy * speed * delta_s;
+            // Setters let an idle renderer notice the move
+            const position = transform.position;
+            transform.setPosition(Vector3.fromXYZ(position.x + dx * speed * delta_s, position.y + dy * speed * delta_s, position.z));
         }
 
+        const rotation = transform.rotation;
         if (input.isPressed(.Q))
-            transform.rotation.z += delta_s;
+            transform.setRotation(Vector3.fromXYZ(rotation.x, rotation.y, rotation.z + delta_s));
 
         if (input.isPressed(.E))
-            transform.rotation.z -= delta_s;
+            transform.setRotation(Vector3.fromXYZ(rotation.x, rotation.y, rotation.z - delta_s));
     }
 
     pub fn destroy(_: *Player1Script) !void {}
@@ -0,0 +1,330 @@
+const std = @import("std");
+
+const zigimg = @import("zigimg");
+
+const Platform = @import("../utils/platform.zig");
+
+const Allocator = std.mem.Allocator;
+
+/// Directory cooked textures are written to, relative to working directory
+pub const cache_directory = ".glaze-cache/textures";
+pub const cache_extension = ".gtex";
+
+const magic = [4]u8{ 'G', 'L', 'Z', 'T' };
+const format_version = 3;
+
+/// Largest source file accepted, guards against reading something that is not an image
+const max_source_size = 256 * 1024 * 1024;
+
+pub const CookedFormat = enum(u32) {
+    Rgba8 = 0,
+};
+
+/// Start of every cooked file, mip levels follow right after it from largest to smallest
+pub const CookedHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    source_hash: u64, // Hash of source file bytes, cooked file is stale when it differs
+    format: CookedFormat,
+    width: u32,
+    height: u32,
+    mip_count: u32,
+    is_translucent: u32, // 1 when some texel is neither fully opaque nor fully transparent, so it has to be blended in order
+};
+
+pub const MipLevel = struct {
+    width: u32,
+    height: u32,
+    offset: usize, // From start of payload
+    pixels: []const u8,
+};
+
+/// Texture ready for upload: RGBA8 pixels with full mip chain.
+/// Backed either by a memory mapped cache file or by memory it owns.
+pub const CookedTexture = struct {
+    header: CookedHeader,
+    bytes: []const u8, // Whole file including header
+    mapped: ?[]align(std.heap.page_size_min) const u8,
+    owned: ?[]u8,
+
+    pub fn deinit(self: *CookedTexture, allocator: Allocator) void {
+        if (Platform.current_platform != .windows) {
+            if (self.mapped) |memory| std.posix.munmap(memory);
+        }
+        if (self.owned) |memory| allocator.free(memory);
+
+        self.mapped = null;
+        self.owned = null;
+    }
+
+    /// Mip levels, level 0 is full size
+    pub fn getMip(self: *const CookedTexture, level: u32) MipLevel {
+        std.debug.assert(level < self.header.mip_count);
+
+        var width = self.header.width;
+        var height = self.header.height;
+        var offset: usize = 0;
+
+        for (0..level) |_| {
+            offset += @as(usize, width) * height * 4;
+            width = @max(1, width / 2);
+            height = @max(1, height / 2);
+        }
+
+        const size = @as(usize, width) * height * 4;
+        const payload = self.getPayload();
+
+        return MipLevel{
+            .width = width,
+            .height = height,
+            .offset = offset,
+            .pixels = payload[offset .. offset + size],
+        };
+    }
+
+    /// Every mip level back to back, can be uploaded from a single buffer
+    pub fn getPayload(self: *const CookedTexture) []const u8 {
+        return self.bytes[@sizeOf(CookedHeader)..];
+    }
+};
+
+/// Loads texture from cache when it is up to date with `source_path`, otherwise decodes source,
+/// cooks it and writes cache for next time. Failing to write cache is logged, not returned.
+pub fn loadOrCook(allocator: Allocator, source_path: []const u8) !CookedTexture {
+    const source = try std.fs.cwd().readFileAlloc(allocator, source_path, max_source_size);
+    defer allocator.free(source);
+
+    const source_hash = hashSource(source);
+
+    var path_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const cache_path = try getCachePath(&path_buffer, source_path);
+
+    if (openCached(allocator, cache_path, source_hash)) |cooked| {
+        return cooked;
+    } else |e| switch (e) {
+        error.FileNotFound, CookedTextureError.StaleCache => {},
+        else => std.log.warn("Ignoring cooked texture {s}: {}", .{ cache_path, e }),
+    }
+
+    const bytes = try cookSource(allocator, source, source_hash);
+    errdefer allocator.free(bytes);
+
+    writeCache(cache_path, bytes) catch |e| {
+        std.log.warn("Failed to write cooked texture {s}: {}", .{ cache_path, e });
+        return fromOwned(bytes);
+    };
+
+    // Mapped file can be paged out by the OS, heap copy would stay in RSS as long as texture is streamed
+    const mapped = openCached(allocator, cache_path, source_hash) catch return fromOwned(bytes);
+    allocator.free(bytes);
+
+    return mapped;
+}
+
+/// Decodes image file bytes and lays them out as a cooked file
+pub fn cookSource(allocator: Allocator, source: []const u8, source_hash: u64) ![]u8 {
+    var image = try zigimg.Image.fromMemory(allocator, source);
+    defer image.deinit(allocator);
+
+    try image.convert(allocator, .rgba32);
+    return cookPixels(allocator, image.pixels.asBytes(), @intCast(image.width), @intCast(image.height), source_hash);
+}
+
+/// Builds cooked file from RGBA8 pixels, generating mip chain with a 2x2 box filter
+pub fn cookPixels(allocator: Allocator, pixels: []const u8, width: u32, height: u32, source_hash: u64) ![]u8 {
+    const mip_count = getMipCount(width, height);
+
+    const bytes = try allocator.alloc(u8, @sizeOf(CookedHeader) + getPayloadSize(width, height, mip_count));
+    errdefer allocator.free(bytes);
+
+    const header = CookedHeader{
+        .magic = magic,
+        .version = format_version,
+        .source_hash = source_hash,
+        .format = .Rgba8,
+        .width = width,
+        .height = height,
+        .mip_count = mip_count,
+        .is_translucent = @intFromBool(hasPartialAlpha(pixels)),
+    };
+    @memcpy(bytes[0..@sizeOf(CookedHeader)], std.mem.asBytes(&header));
+
+    var payload = bytes[@sizeOf(CookedHeader)..];
+    @memcpy(payload[0..pixels.len], pixels);
+
+    var previous_offset: usize = 0;
+    var offset: usize = pixels.len;
+    var level_width = width;
+    var level_height = height;
+
+    for (1..mip_count) |_| {
+        const next_width = @max(1, level_width / 2);
+        const next_height = @max(1, level_height / 2);
+        const next_size = @as(usize, next_width) * next_height * 4;
+
+        downsample(payload[previous_offset..offset], level_width, level_height, payload[offset .. offset + next_size], next_width, next_height);
+
+        previous_offset = offset;
+        offset += next_size;
+        level_width = next_width;
+        level_height = next_height;
+    }
+
+    return bytes;
+}
+
+pub fn hashSource(source: []const u8) u64 {
+    return std.hash.Wyhash.hash(format_version, source);
+}
+
+/// Cache file for `source_path`, named after hash of the path
+pub fn getCachePath(buffer: []u8, source_path: []const u8) ![]const u8 {
+    const path_hash = std.hash.Wyhash.hash(0, source_path);
+    return std.fmt.bufPrint(buffer, "{s}/{x:0>16}{s}", .{ cache_directory, path_hash, cache_extension });
+}
+
+pub fn getMipCount(width: u32, height: u32) u32 {
+    return std.math.log2_int(u32, @max(1, @max(width, height))) + 1;
+}
+
+/// Bytes taken by `mip_count` levels of RGBA8 pixels
+pub fn getPayloadSize(width: u32, height: u32, mip_count: u32) usize {
+    var size: usize = 0;
+    var level_width = width;
+    var level_height = height;
+
+    for (0..mip_count) |_| {
+        size += @as(usize, level_width) * level_height * 4;
+        level_width = @max(1, level_width / 2);
+        level_height = @max(1, level_height / 2);
+    }
+
+    return size;
+}
+
+// --------------------------- HELPER FUNCTIONS --------------------------- //
+/// Whether any RGBA8 texel has alpha between 0 and 255. Fully transparent texels blend to nothing, so
+/// textures with only hard edges look the same in any order.
+fn hasPartialAlpha(pixels: []const u8) bool {
+    var i: usize = 3;
+    while (i < pixels.len) : (i += 4) {
+        if (pixels[i] != 0 and pixels[i] != 255) return true;
+    }
+
+    return false;
+}
+
+/// Opens cooked file, memory mapped where the platform allows it
+///
+/// # Errors
+/// - `StaleCache`: File was cooked from a different source or by a different format version
+/// - `InvalidCookedFile`: File is truncated or not a cooked texture
+fn openCached(allocator: Allocator, cache_path: []const u8, source_hash: u64) !CookedTexture {
+    const file = try std.fs.cwd().openFile(cache_path, .{});
+    defer file.close();
+
+    const size = try file.getEndPos();
+    if (size < @sizeOf(CookedHeader)) return CookedTextureError.InvalidCookedFile;
+
+    var cooked = if (Platform.current_platform == .windows) blk: {
+        const bytes = try allocator.alloc(u8, size);
+        errdefer allocator.free(bytes);
+
+        if (try file.preadAll(bytes, 0) != size) return CookedTextureError.InvalidCookedFile;
+        break :blk try fromOwned(bytes);
+    } else blk: {
+        const memory = try std.posix.mmap(null, size, std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, file.handle, 0);
+        errdefer std.posix.munmap(memory);
+
+        var mapped_texture = try fromBytes(memory);
+        mapped_texture.mapped = memory;
+        break :blk mapped_texture;
+    };
+    errdefer cooked.deinit(allocator);
+
+    if (cooked.header.source_hash != source_hash) return CookedTextureError.StaleCache;
+    return cooked;
+}
+
+fn fromOwned(bytes: []u8) !CookedTexture {
+    var cooked = try fromBytes(bytes);
+    cooked.owned = bytes;
+    return cooked;
+}
+
+fn fromBytes(bytes: []const u8) !CookedTexture {
+    if (bytes.len < @sizeOf(CookedHeader)) return CookedTextureError.InvalidCookedFile;
+
+    const header = std.mem.bytesToValue(CookedHeader, bytes[0..@sizeOf(CookedHeader)]);
+    if (!std.mem.eql(u8, &header.magic, &magic)) return CookedTextureError.InvalidCookedFile;
+    if (header.version != format_version) return CookedTextureError.StaleCache;
+    if (header.format != .Rgba8) return CookedTextureError.InvalidCookedFile;
+
+    if (header.mip_count == 0 or header.mip_count > getMipCount(header.width, header.height)) return CookedTextureError.InvalidCookedFile;
+
+    // Last mip has to end inside the file
+    const payload_size = getPayloadSize(header.width, header.height, header.mip_count);
+    if (@sizeOf(CookedHeader) + payload_size > bytes.len) return CookedTextureError.InvalidCookedFile;
+
+    return CookedTexture{
+        .header = header,
+        .bytes = bytes,
+        .mapped = null,
+        .owned = null,
+    };
+}
+
+/// Writes into a temporary file first so a crash never leaves a half written cache behind
+fn writeCache(cache_path: []const u8, bytes: []const u8) !void {
+    const cwd = std.fs.cwd();
+    try cwd.makePath(cache_directory);
+
+    var temp_buffer: [std.fs.max_path_bytes]u8 = undefined;
+    const temp_path = try std.fmt.bufPrint(&temp_buffer, "{s}.tmp", .{cache_path});
+
+    try cwd.writeFile(.{ .sub_path = temp_path, .data = bytes });
+    try cwd.rename(temp_path, cache_path);
+}
+
+/// Averages 2x2 blocks, edges of odd sized levels reuse the last row or column.
+/// Color is weighted by alpha, otherwise color of fully transparent texels bleeds into sprite edges at coarser levels.
+fn downsample(source: []const u8, source_width: u32, source_height: u32, destination: []u8, width: u32, height: u32) void {
+    const last_x: usize = source_width - 1;
+    const last_y: usize = source_height - 1;
+    const source_stride: usize = @as(usize, source_width) * 4;
+
+    for (0..height) |y| {
+        const row0 = @min(y * 2, last_y) * source_stride;
+        const row1 = @min(y * 2 + 1, last_y) * source_stride;
+
+        for (0..width) |x| {
+            const column0 = @min(x * 2, last_x) * 4;
+            const column1 = @min(x * 2 + 1, last_x) * 4;
+
+            const texels = [4]usize{ row0 + column0, row0 + column1, row1 + column0, row1 + column1 };
+
+            var alpha_sum: u32 = 0;
+            for (texels) |texel| alpha_sum += source[texel + 3];
+
+            const output = (y * width + x) * 4;
+            for (0..3) |channel| {
+                var sum: u32 = 0;
+                var weighted_sum: u32 = 0;
+                for (texels) |texel| {
+                    sum += source[texel + channel];
+                    weighted_sum += @as(u32, source[texel + channel]) * source[texel + 3];
+                }
+
+                // Fully transparent block keeps plain average, it is never seen anyway
+                destination[output + channel] = @intCast(if (alpha_sum == 0) (sum + 2) / 4 else (weighted_sum + alpha_sum / 2) / alpha_sum);
+            }
+
+            destination[output + 3] = @intCast((alpha_sum + 2) / 4);
+        }
+    }
+}
+
+pub const CookedTextureError = error{
+    InvalidCookedFile,
+    StaleCache,
+};
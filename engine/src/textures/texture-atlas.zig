@@ -0,0 +1,337 @@
+const std = @import("std");
+
+const c = @cImport({
+    @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
+});
+
+const GlState = @import("../renderer/gl/gl-state.zig").GlState;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Empty pixels kept around every sprite so linear filtering never samples a neighbour
+const padding = 1;
+const preferred_page_size = 2048;
+
+/// Part of a GL texture a sprite occupies
+pub const TextureRegion = struct {
+    texture: c.GLuint,
+    uv_rect: [4]f32, // u0, v0, u1, v1
+
+    pub const full_uv_rect = [4]f32{ 0.0, 0.0, 1.0, 1.0 };
+
+    /// Region covering whole texture
+    pub fn whole(texture: c.GLuint) TextureRegion {
+        return TextureRegion{
+            .texture = texture,
+            .uv_rect = full_uv_rect,
+        };
+    }
+};
+
+pub const PackedRect = struct {
+    x: u32,
+    y: u32,
+};
+
+/// Skyline bottom-left packer. Keeps the top edge of packed rects as a list of horizontal segments
+/// and places each new rect on the segment where its top ends up lowest.
+/// Already packed rects never move, so adding sprites never touches existing ones.
+pub const SkylinePacker = struct {
+    const Segment = struct {
+        x: u32,
+        y: u32,
+        width: u32,
+    };
+
+    allocator: Allocator,
+    width: u32,
+    height: u32,
+    skyline: ArrayList(Segment),
+    used_area: u64,
+
+    pub fn init(allocator: Allocator, width: u32, height: u32) !SkylinePacker {
+        var skyline = ArrayList(Segment){};
+        try skyline.append(allocator, Segment{ .x = 0, .y = 0, .width = width });
+
+        return SkylinePacker{
+            .allocator = allocator,
+            .width = width,
+            .height = height,
+            .skyline = skyline,
+            .used_area = 0,
+        };
+    }
+
+    pub fn deinit(self: *SkylinePacker) void {
+        self.skyline.deinit(self.allocator);
+    }
+
+    /// Finds place for `width` x `height` rect
+    ///
+    /// # Returns
+    /// - `?PackedRect`: Top-left corner of the rect or null if it does not fit
+    pub fn pack(self: *SkylinePacker, width: u32, height: u32) !?PackedRect {
+        var best_index: ?usize = null;
+        var best_y: u32 = std.math.maxInt(u32);
+        var best_width: u32 = std.math.maxInt(u32);
+
+        for (0..self.skyline.items.len) |i| {
+            const y = self.fitAt(i, width, height) orelse continue;
+            const segment_width = self.skyline.items[i].width;
+
+            if (y < best_y or (y == best_y and segment_width < best_width)) {
+                best_index = i;
+                best_y = y;
+                best_width = segment_width;
+            }
+        }
+
+        const index = best_index orelse return null;
+        const x = self.skyline.items[index].x;
+
+        try self.addSegment(index, Segment{ .x = x, .y = best_y + height, .width = width });
+        self.used_area += @as(u64, width) * height;
+
+        return PackedRect{ .x = x, .y = best_y };
+    }
+
+    /// Fraction of page covered by packed rects
+    pub fn getOccupancy(self: *const SkylinePacker) f32 {
+        const total: f32 = @floatFromInt(@as(u64, self.width) * self.height);
+        return @as(f32, @floatFromInt(self.used_area)) / total;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    /// Returns y at which rect starting at segment `index` would sit, null if it does not fit
+    fn fitAt(self: *const SkylinePacker, index: usize, width: u32, height: u32) ?u32 {
+        const x = self.skyline.items[index].x;
+        if (x + width > self.width) return null;
+
+        var remaining = width;
+        var y: u32 = 0;
+        var i = index;
+
+        while (remaining > 0) : (i += 1) {
+            if (i >= self.skyline.items.len) return null;
+
+            const segment = self.skyline.items[i];
+            y = @max(y, segment.y);
+            if (y + height > self.height) return null;
+
+            remaining -|= segment.width;
+        }
+
+        return y;
+    }
+
+    /// Inserts new top segment and trims or removes segments it covers
+    fn addSegment(self: *SkylinePacker, index: usize, segment: Segment) !void {
+        try self.skyline.insert(self.allocator, index, segment);
+
+        const right = segment.x + segment.width;
+        var i = index + 1;
+
+        while (i < self.skyline.items.len) {
+            const current = &self.skyline.items[i];
+            if (current.x >= right) break;
+
+            const current_right = current.x + current.width;
+            if (current_right <= right) {
+                _ = self.skyline.orderedRemove(i);
+                continue;
+            }
+
+            current.width = current_right - right;
+            current.x = right;
+            break;
+        }
+
+        self.mergeSegments();
+    }
+
+    fn mergeSegments(self: *SkylinePacker) void {
+        var i: usize = 0;
+        while (i + 1 < self.skyline.items.len) {
+            const current = &self.skyline.items[i];
+            const next = self.skyline.items[i + 1];
+
+            if (current.y == next.y) {
+                current.width += next.width;
+                _ = self.skyline.orderedRemove(i + 1);
+            } else {
+                i += 1;
+            }
+        }
+    }
+};
+
+/// GL texture shared by many sprites
+const AtlasPage = struct {
+    texture: c.GLuint,
+    packer: SkylinePacker,
+    sprite_count: u32, // Page is freed when last sprite on it is released
+};
+
+/// Packs small textures into shared pages so sprites using them can be drawn in one batch.
+/// Pages are created on demand, new sprites go to the first page they fit in.
+pub const TextureAtlas = struct {
+    allocator: Allocator,
+    pages: ArrayList(AtlasPage),
+    page_size: u32,
+
+    pub fn init(allocator: Allocator) TextureAtlas {
+        return TextureAtlas{
+            .allocator = allocator,
+            .pages = ArrayList(AtlasPage){},
+            .page_size = 0,
+        };
+    }
+
+    /// Frees pages and their GL textures. Must be called on the thread that owns GL context.
+    pub fn deinit(self: *TextureAtlas) void {
+        for (self.pages.items) |*page| {
+            GlState.get().deleteTexture(page.texture);
+            page.packer.deinit();
+        }
+
+        self.pages.deinit(self.allocator);
+    }
+
+    /// Largest sprite side the atlas accepts, anything bigger should get its own texture
+    pub fn getMaxSpriteSize(self: *TextureAtlas) u32 {
+        return self.getPageSize() / 2;
+    }
+
+    /// Copies RGBA8 pixels into a page
+    ///
+    /// # Arguments
+    /// - `pixels`: Tightly packed RGBA8 pixels
+    /// - `width`: Width in pixels
+    /// - `height`: Height in pixels
+    ///
+    /// # Returns
+    /// - `TextureRegion`: Page texture and UV rect of the sprite inside of it
+    ///
+    /// # Errors
+    /// - `SpriteTooLarge`: Sprite is larger than `getMaxSpriteSize()`
+    pub fn add(self: *TextureAtlas, pixels: []const u8, width: u32, height: u32) !TextureRegion {
+        if (width > self.getMaxSpriteSize() or height > self.getMaxSpriteSize()) return TextureAtlasError.SpriteTooLarge;
+
+        const padded_width = width + 2 * padding;
+        const padded_height = height + 2 * padding;
+
+        for (self.pages.items) |*page| {
+            if (try page.packer.pack(padded_width, padded_height)) |rect| {
+                return self.upload(page, rect, pixels, width, height);
+            }
+        }
+
+        const page = try self.addPage();
+        const rect = try page.packer.pack(padded_width, padded_height) orelse return TextureAtlasError.SpriteTooLarge;
+        return self.upload(page, rect, pixels, width, height);
+    }
+
+    /// Releases sprite added with `add()`. Packed space is only reclaimed once every sprite on the page is released,
+    /// then the page is deleted.
+    pub fn release(self: *TextureAtlas, region: TextureRegion) void {
+        for (self.pages.items, 0..) |*page, i| {
+            if (page.texture != region.texture) continue;
+
+            page.sprite_count -= 1;
+            if (page.sprite_count == 0) {
+                GlState.get().deleteTexture(page.texture);
+                page.packer.deinit();
+                _ = self.pages.swapRemove(i);
+            }
+
+            return;
+        }
+    }
+
+    /// Whether releasing `region` deletes its page, i.e. no other sprite is left on it
+    pub fn isLastOnPage(self: *const TextureAtlas, region: TextureRegion) bool {
+        for (self.pages.items) |page| {
+            if (page.texture == region.texture) return page.sprite_count == 1;
+        }
+
+        return false;
+    }
+
+    pub fn getPageCount(self: *TextureAtlas) usize {
+        return self.pages.items.len;
+    }
+
+    /// GPU memory taken by pages
+    pub fn getResidentBytes(self: *const TextureAtlas) usize {
+        return self.pages.items.len * @as(usize, self.page_size) * self.page_size * 4;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn getPageSize(self: *TextureAtlas) u32 {
+        if (self.page_size == 0) {
+            var max_size: c.GLint = 0;
+            c.glGetIntegerv(c.GL_MAX_TEXTURE_SIZE, &max_size);
+            self.page_size = if (max_size > 0) @min(preferred_page_size, @as(u32, @intCast(max_size))) else preferred_page_size;
+        }
+
+        return self.page_size;
+    }
+
+    fn addPage(self: *TextureAtlas) !*AtlasPage {
+        const size = self.getPageSize();
+
+        var packer = try SkylinePacker.init(self.allocator, size, size);
+        errdefer packer.deinit();
+
+        // Page starts transparent so padding around sprites blends to nothing
+        const clear_pixels = try self.allocator.alloc(u8, @as(usize, size) * size * 4);
+        defer self.allocator.free(clear_pixels);
+        @memset(clear_pixels, 0);
+
+        var texture: c.GLuint = 0;
+        c.glGenTextures(1, &texture);
+        GlState.get().bindTexture2D(0, texture);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MIN_FILTER, c.GL_LINEAR);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MAG_FILTER, c.GL_LINEAR);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_WRAP_S, c.GL_CLAMP_TO_EDGE);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_WRAP_T, c.GL_CLAMP_TO_EDGE);
+        c.glTexImage2D(c.GL_TEXTURE_2D, 0, c.GL_RGBA, @intCast(size), @intCast(size), 0, c.GL_RGBA, c.GL_UNSIGNED_BYTE, clear_pixels.ptr);
+
+        try self.pages.append(self.allocator, AtlasPage{
+            .texture = texture,
+            .packer = packer,
+            .sprite_count = 0,
+        });
+
+        return &self.pages.items[self.pages.items.len - 1];
+    }
+
+    fn upload(self: *TextureAtlas, page: *AtlasPage, rect: PackedRect, pixels: []const u8, width: u32, height: u32) TextureRegion {
+        const x = rect.x + padding;
+        const y = rect.y + padding;
+
+        page.sprite_count += 1;
+
+        GlState.get().bindTexture2D(0, page.texture);
+        c.glPixelStorei(c.GL_UNPACK_ALIGNMENT, 1);
+        c.glTexSubImage2D(c.GL_TEXTURE_2D, 0, @intCast(x), @intCast(y), @intCast(width), @intCast(height), c.GL_RGBA, c.GL_UNSIGNED_BYTE, pixels.ptr);
+
+        const size: f32 = @floatFromInt(self.getPageSize());
+
+        // Half texel inset keeps linear filtering inside the sprite at its edges
+        return TextureRegion{
+            .texture = page.texture,
+            .uv_rect = .{
+                (@as(f32, @floatFromInt(x)) + 0.5) / size,
+                (@as(f32, @floatFromInt(y)) + 0.5) / size,
+                (@as(f32, @floatFromInt(x + width)) - 0.5) / size,
+                (@as(f32, @floatFromInt(y + height)) - 0.5) / size,
+            },
+        };
+    }
+};
+
+pub const TextureAtlasError = error{
+    SpriteTooLarge,
+};
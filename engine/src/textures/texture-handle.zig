@@ -0,0 +1,67 @@
+const std = @import("std");
+
+const TextureRegion = @import("texture-atlas.zig").TextureRegion;
+const CookedTexture = @import("cooked-texture.zig").CookedTexture;
+
+pub const TextureState = enum {
+    Loading,
+    Ready,
+    Failed,
+};
+
+/// Mip levels of a standalone texture that are uploaded, see `TextureManager.updateResidency()`
+pub const MipResidency = struct {
+    cooked: CookedTexture, // Levels are streamed from here, usually memory mapped
+    resident_level: u32, // Finest level uploaded, it is level 0 of the GL texture
+    screen_size: f32, // Largest on-screen size in pixels since last residency update
+};
+
+/// Texture loaded from a file. Owned by `TextureManager`, address never changes while it is cached.
+pub const TextureAsset = struct {
+    path: []const u8, // Owned, also used as key in `TextureManager.textures`
+    state: TextureState,
+    region: TextureRegion, // Only valid once `state` is `Ready`
+    allow_atlas: bool,
+    is_translucent: bool, // Texture has partially transparent texels, only valid once `state` is `Ready`
+    residency: ?MipResidency, // Only for standalone textures, atlas pages are never streamed
+    last_used_frame: u64, // Frame it was last resolved for drawing, unreferenced assets are evicted oldest first
+
+    ref_count: std.atomic.Value(u32), // Asset can only be evicted while this is 0
+};
+
+/// Counted reference to a texture asset, keeps it from being evicted.
+/// Resolving it to a region does not touch any map, so sprites can keep one around and draw with it every frame.
+/// Counter is atomic because handles are acquired and released on any thread, which `RefCounter` does not allow.
+pub const TextureHandle = struct {
+    asset: *TextureAsset,
+
+    /// Wraps asset and takes a reference to it
+    pub fn init(asset: *TextureAsset) TextureHandle {
+        _ = asset.ref_count.fetchAdd(1, .monotonic);
+        return TextureHandle{ .asset = asset };
+    }
+
+    /// Returns another handle to the same asset
+    pub fn clone(self: TextureHandle) TextureHandle {
+        return TextureHandle.init(self.asset);
+    }
+
+    /// Drops reference, handle must not be used afterwards
+    pub fn release(self: TextureHandle) void {
+        const previous = self.asset.ref_count.fetchSub(1, .release);
+        std.debug.assert(previous > 0);
+    }
+
+    pub fn getState(self: TextureHandle) TextureState {
+        return self.asset.state;
+    }
+
+    /// Whether texture has partially transparent texels, false until it is loaded
+    pub fn isTranslucent(self: TextureHandle) bool {
+        return self.asset.state == .Ready and self.asset.is_translucent;
+    }
+
+    pub fn getPath(self: TextureHandle) []const u8 {
+        return self.asset.path;
+    }
+};
@@ -0,0 +1,160 @@
+const std = @import("std");
+
+const cooked_texture = @import("cooked-texture.zig");
+const CookedTexture = cooked_texture.CookedTexture;
+
+const c_allocator_util = @import("../utils/c_allocator_util.zig");
+const cAlloc = c_allocator_util.cAlloc;
+const cFree = c_allocator_util.cFree;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Decoding is mostly inflate, more workers than this only fight the game for cores
+const max_decode_workers = 4;
+
+/// Texture loaded on a worker, waiting to be uploaded on the GL thread
+pub const DecodedTexture = struct {
+    path: []const u8, // Borrowed from whoever queued the decode, has to outlive it
+    texture: ?CookedTexture, // Null if loading failed
+    err: ?anyerror,
+
+    pub fn deinit(self: *DecodedTexture) void {
+        if (self.texture) |*texture| texture.deinit(decode_allocator);
+        self.texture = null;
+    }
+};
+
+/// Allocator cooked textures are loaded with, also used to free them
+pub const decode_allocator = std.heap.smp_allocator;
+
+/// Loads textures on worker threads, from cooked cache when it is up to date and by decoding source otherwise.
+/// Finished textures are collected until the GL thread takes them.
+/// Never touches GL, so decodes can be queued from any thread.
+pub const TextureLoader = struct {
+    allocator: Allocator,
+    worker_pool: ?*std.Thread.Pool,
+
+    mutex: std.Thread.Mutex,
+    finished_condition: std.Thread.Condition,
+    finished: ArrayList(DecodedTexture),
+    in_flight: usize,
+
+    on_finished: ?*const fn (data: ?*anyopaque) void, // Called on decoding thread after every decode, e.g. to wake renderer
+    on_finished_data: ?*anyopaque,
+
+    pub fn init(allocator: Allocator) TextureLoader {
+        return TextureLoader{
+            .allocator = allocator,
+            .worker_pool = null,
+            .mutex = .{},
+            .finished_condition = .{},
+            .finished = ArrayList(DecodedTexture){},
+            .in_flight = 0,
+            .on_finished = null,
+            .on_finished_data = null,
+        };
+    }
+
+    /// Waits for decodes in flight and frees images that were never taken
+    pub fn deinit(self: *TextureLoader) void {
+        if (self.worker_pool) |pool| {
+            pool.deinit();
+            cFree(pool);
+        }
+
+        for (self.finished.items) |*decoded| decoded.deinit();
+        self.finished.deinit(self.allocator);
+    }
+
+    /// Starts decoding `path`. Without worker threads the image is decoded right away.
+    ///
+    /// # Arguments
+    /// - `path`: File to decode, has to stay valid until its `DecodedTexture` is taken
+    pub fn queue(self: *TextureLoader, path: []const u8) !void {
+        self.mutex.lock();
+        self.in_flight += 1;
+        const maybe_pool = self.getWorkerPool();
+        self.mutex.unlock();
+
+        const pool = maybe_pool catch |e| {
+            std.log.warn("Texture decode runs on calling thread: {}", .{e});
+            decode(self, path);
+            return;
+        };
+
+        pool.spawn(decode, .{ self, path }) catch |e| {
+            self.mutex.lock();
+            self.in_flight -= 1;
+            self.mutex.unlock();
+            return e;
+        };
+    }
+
+    /// Moves every finished decode into `destination`, never blocks on decoding
+    pub fn takeFinished(self: *TextureLoader, destination: *ArrayList(DecodedTexture), allocator: Allocator) !void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        try destination.appendSlice(allocator, self.finished.items);
+        self.finished.clearRetainingCapacity();
+    }
+
+    /// Blocks until at least one decode finished or nothing is in flight anymore
+    pub fn waitForFinished(self: *TextureLoader) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        while (self.finished.items.len == 0 and self.in_flight > 0) {
+            self.finished_condition.wait(&self.mutex);
+        }
+    }
+
+    /// Whether decodes are in flight or finished ones were not taken yet
+    pub fn isBusy(self: *TextureLoader) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        return self.in_flight > 0 or self.finished.items.len > 0;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn decode(self: *TextureLoader, path: []const u8) void {
+        var decoded = DecodedTexture{ .path = path, .texture = null, .err = null };
+
+        if (cooked_texture.loadOrCook(decode_allocator, path)) |texture| {
+            decoded.texture = texture;
+        } else |e| {
+            decoded.err = e;
+        }
+
+        {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            self.in_flight -= 1;
+            defer self.finished_condition.broadcast();
+
+            self.finished.append(self.allocator, decoded) catch |e| {
+                std.log.err("Dropping decoded texture {s}: {}", .{ path, e });
+                decoded.deinit();
+            };
+        }
+
+        if (self.on_finished) |on_finished| on_finished(self.on_finished_data);
+    }
+
+    /// Caller has to hold `mutex`
+    fn getWorkerPool(self: *TextureLoader) !*std.Thread.Pool {
+        if (self.worker_pool) |pool| return pool;
+
+        const pool = try cAlloc(std.Thread.Pool);
+        errdefer cFree(pool);
+
+        const cpu_count = std.Thread.getCpuCount() catch 2;
+        try pool.init(.{ .allocator = self.allocator, .n_jobs = @min(max_decode_workers, @max(1, cpu_count -| 1)) });
+        self.worker_pool = pool;
+
+        return pool;
+    }
+};
@@ -1,17 +1,106 @@
 const std = @import("std");
 
-const zigimg = @import("zigimg");
-
 const c = @cImport({
     @cInclude("../src/renderer/gl/glad/include/glad/gl.h");
 });
 
+const GlState = @import("../renderer/gl/gl-state.zig").GlState;
+
+const texture_atlas = @import("texture-atlas.zig");
+const TextureAtlas = texture_atlas.TextureAtlas;
+pub const TextureRegion = texture_atlas.TextureRegion;
+
+const texture_handle = @import("texture-handle.zig");
+const TextureAsset = texture_handle.TextureAsset;
+const MipResidency = texture_handle.MipResidency;
+pub const TextureHandle = texture_handle.TextureHandle;
+pub const TextureState = texture_handle.TextureState;
+
+const texture_loader = @import("texture-loader.zig");
+const TextureLoader = texture_loader.TextureLoader;
+const DecodedTexture = texture_loader.DecodedTexture;
+
+const CookedTexture = @import("cooked-texture.zig").CookedTexture;
+
+const Allocator = std.mem.Allocator;
+const ArrayList = std.ArrayList;
+
+/// Sprites with either side above this get their own texture by default
+const default_atlas_max_sprite_size = 256;
+
+/// GPU memory textures may use before unreferenced ones are evicted and streamed ones lose their finest mips
+const default_memory_budget = 256 * 1024 * 1024;
+
+/// Levels with both sides at or below this are always resident, they are what a texture first appears with
+const min_resident_size = 64;
+
+/// Textures not drawn for this many frames keep only their coarse levels
+const idle_frame_count = 120;
+
+/// Streaming a level in re-uploads it together with every coarser level, so only a few are done per frame
+const max_stream_uploads_per_frame = 2;
+
+// 2x2 grey checker shown while the real texture is decoding
+const placeholder_pixels = [_]u8{
+    160, 160, 160, 255, 96,  96,  96,  255,
+    96,  96,  96,  255, 160, 160, 160, 255,
+};
+
+pub const TextureStats = struct {
+    resident_bytes: usize, // Atlas pages and uploaded mip levels
+    memory_budget: usize,
+    texture_count: usize,
+    evictions: u64,
+    reloads: u64, // Loads of textures that were evicted before
+};
+
+/// Loads textures without stalling the frame. Files are decoded on worker threads and uploaded
+/// on the GL thread within a per frame time budget, sprites draw with a placeholder until then.
 pub const TextureManager = struct {
-    textures: std.StringHashMap(c.GLuint),
+    allocator: Allocator,
+
+    mutex: std.Thread.Mutex, // Guards `textures` and asset states, everything else is only used on the GL thread
+    textures: std.StringHashMap(*TextureAsset), // Keys are owned by assets
+    loader: TextureLoader,
+    pending_uploads: ArrayList(DecodedTexture),
+
+    atlas: TextureAtlas,
+    atlas_max_sprite_size: u32, // 0 disables atlas
+
+    placeholder: TextureRegion,
+    pixel_buffer: c.GLuint, // Pixel unpack buffer large uploads go through
+
+    streamed: ArrayList(*TextureAsset), // Assets with mip residency
+    eviction_candidates: ArrayList(*TextureAsset), // Filled by `collectEvictionCandidates()`, reused every update
+    streamed_bytes: usize,
+    memory_budget: usize,
+    frame_index: u64,
+    is_streaming: bool, // Last `updateResidency()` streamed in mips, next one may stream more
+
+    evicted_paths: std.AutoHashMap(u64, void), // Path hashes, to tell reloads apart from first loads
+    eviction_count: u64,
+    reload_count: u64,
 
     pub fn init() TextureManager {
         return .{
-            .textures = std.StringHashMap(c.GLuint).init(std.heap.page_allocator),
+            .allocator = std.heap.page_allocator,
+            .mutex = .{},
+            .textures = std.StringHashMap(*TextureAsset).init(std.heap.page_allocator),
+            .loader = TextureLoader.init(std.heap.page_allocator),
+            .pending_uploads = ArrayList(DecodedTexture){},
+            .atlas = TextureAtlas.init(std.heap.page_allocator),
+            .atlas_max_sprite_size = default_atlas_max_sprite_size,
+            .placeholder = TextureRegion.whole(0),
+            .pixel_buffer = 0,
+            .streamed = ArrayList(*TextureAsset){},
+            .eviction_candidates = ArrayList(*TextureAsset){},
+            .streamed_bytes = 0,
+            .memory_budget = default_memory_budget,
+            .frame_index = 0,
+            .is_streaming = false,
+            .evicted_paths = std.AutoHashMap(u64, void).init(std.heap.page_allocator),
+            .eviction_count = 0,
+            .reload_count = 0,
         };
     }
 
@@ -19,33 +108,541 @@ pub const TextureManager = struct {
         return std.hash.Wyhash.hash(0, path);
     }
 
-    pub fn getOrLoad(self: *TextureManager, path: []const u8) !c.GLuint {
-        if (self.textures.get(path)) |tex| {
-            return tex;
+    /// Returns texture, packing it into a shared atlas page when it is small enough.
+    /// Starts loading it on first call and returns placeholder until it is uploaded. GL thread only.
+    ///
+    /// # Returns
+    /// - `TextureRegion`: Texture to bind and UV rect of the sprite inside of it
+    ///
+    /// # Errors
+    /// - `LoadFailed`: File could not be decoded
+    pub fn getOrLoad(self: *TextureManager, path: []const u8) !TextureRegion {
+        return self.request(path, true);
+    }
+
+    /// Same as `getOrLoad()` but texture gets its own GL texture, never a place in atlas.
+    /// Use for textures that are sampled outside of their sprite rect, e.g. repeating backgrounds.
+    pub fn getOrLoadStandalone(self: *TextureManager, path: []const u8) !TextureRegion {
+        return self.request(path, false);
+    }
+
+    /// Returns handle to texture, loading it in the background on first use. Safe to call from any thread.
+    /// Resolve it with `resolve()` when drawing, release it when it is no longer needed.
+    pub fn acquire(self: *TextureManager, path: []const u8) !TextureHandle {
+        return TextureHandle{ .asset = try self.queueLoad(path, true, true) };
+    }
+
+    /// Same as `acquire()` but texture gets its own GL texture, see `getOrLoadStandalone()`
+    pub fn acquireStandalone(self: *TextureManager, path: []const u8) !TextureHandle {
+        return TextureHandle{ .asset = try self.queueLoad(path, false, true) };
+    }
+
+    /// Region to draw `handle` with this frame: placeholder while loading, no texture if loading failed. GL thread only.
+    pub fn resolve(self: *TextureManager, handle: TextureHandle) TextureRegion {
+        handle.asset.last_used_frame = self.frame_index;
+
+        return switch (handle.asset.state) {
+            .Ready => handle.asset.region,
+            .Loading => self.getPlaceholder(),
+            .Failed => TextureRegion.whole(0),
+        };
+    }
+
+    /// Records size `handle` is drawn at this frame, finer mips are streamed in when it grows. GL thread only.
+    ///
+    /// # Arguments
+    /// - `screen_size`: Longest side of the sprite on screen in pixels
+    pub fn noteUsage(self: *TextureManager, handle: TextureHandle, screen_size: f32) void {
+        if (handle.asset.residency) |*residency| {
+            residency.screen_size = @max(residency.screen_size, screen_size);
+        }
+    }
+
+    /// Streams finer mips of textures drawn larger than their resident levels. While over budget
+    /// evicts unreferenced textures and then drops mips, least recently drawn first. Call once per frame. GL thread only.
+    pub fn updateResidency(self: *TextureManager) void {
+        self.frame_index += 1;
+
+        // Idle textures go first, then whatever was drawn longest ago
+        for (self.streamed.items) |asset| {
+            if (self.frame_index - asset.last_used_frame > idle_frame_count) {
+                self.setResidentLevel(asset, getCoarsestResidentLevel(&asset.residency.?.cooked));
+            }
+        }
+
+        if (self.getResidentBytes() > self.memory_budget) {
+            self.collectEvictionCandidates(true);
+
+            for (self.eviction_candidates.items) |victim| {
+                const resident_bytes = self.getResidentBytes();
+                if (resident_bytes <= self.memory_budget) break;
+
+                // Nothing was freed, e.g. a handle was acquired in the meantime, evicting more would not help either
+                self.evict(victim);
+                if (self.getResidentBytes() >= resident_bytes) break;
+            }
+        }
+
+        while (self.getResidentBytes() > self.memory_budget) {
+            if (!self.dropLeastRecentlyUsed()) break;
+        }
+
+        var uploads_left: usize = max_stream_uploads_per_frame;
+        for (self.streamed.items) |asset| {
+            const residency = &asset.residency.?;
+            defer residency.screen_size = 0.0;
+
+            if (uploads_left == 0) continue;
+
+            const wanted = getWantedLevel(residency);
+            if (wanted >= residency.resident_level) continue;
+
+            // One level at a time keeps each upload small and lets budget check run in between
+            const next = residency.resident_level - 1;
+            const extra = getResidentSize(&residency.cooked, next) - getResidentSize(&residency.cooked, residency.resident_level);
+            if (self.getResidentBytes() + extra > self.memory_budget) continue;
+
+            self.setResidentLevel(asset, next);
+            uploads_left -= 1;
+        }
+
+        self.is_streaming = uploads_left != max_stream_uploads_per_frame;
+    }
+
+    /// Whether textures are still loading or streaming in, so the following frames may look different even if
+    /// nothing in the scene changes. GL thread only.
+    pub fn hasPendingWork(self: *TextureManager) bool {
+        return self.pending_uploads.items.len > 0 or self.is_streaming or self.loader.isBusy();
+    }
+
+    /// Evicts every texture nothing holds a handle to, e.g. after switching scenes. GL thread only.
+    pub fn evictUnreferenced(self: *TextureManager) void {
+        self.collectEvictionCandidates(false);
+        for (self.eviction_candidates.items) |asset| self.evict(asset);
+    }
+
+    /// Sets GPU memory textures may use, textures are evicted on next update while above it
+    pub fn setMemoryBudget(self: *TextureManager, bytes: usize) void {
+        self.memory_budget = bytes;
+    }
+
+    /// Bytes of atlas pages and mip levels currently uploaded
+    pub fn getResidentBytes(self: *const TextureManager) usize {
+        return self.streamed_bytes + self.atlas.getResidentBytes();
+    }
+
+    pub fn getStats(self: *TextureManager) TextureStats {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        return TextureStats{
+            .resident_bytes = self.getResidentBytes(),
+            .memory_budget = self.memory_budget,
+            .texture_count = self.textures.count(),
+            .evictions = self.eviction_count,
+            .reloads = self.reload_count,
+        };
+    }
+
+    /// Starts decoding textures that will be needed soon. Safe to call from any thread.
+    pub fn prefetch(self: *TextureManager, paths: []const []const u8) !void {
+        for (paths) |path| _ = try self.queueLoad(path, true, false);
+    }
+
+    /// Whether every texture in `paths` finished loading, successfully or not. Safe to call from any thread.
+    pub fn areReady(self: *TextureManager, paths: []const []const u8) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        for (paths) |path| {
+            const asset = self.textures.get(path) orelse return false;
+            if (asset.state == .Loading) return false;
+        }
+
+        return true;
+    }
+
+    /// Loads `paths` and blocks until all of them are uploaded, ignoring upload budget. GL thread only.
+    ///
+    /// # Errors
+    /// - `LoadFailed`: A texture is still loading but nothing is decoding or waiting for upload, it would never finish
+    pub fn waitFor(self: *TextureManager, paths: []const []const u8) !void {
+        try self.prefetch(paths);
+
+        while (!self.areReady(paths)) {
+            if (self.pending_uploads.items.len == 0 and !self.loader.isBusy()) return TextureManagerError.LoadFailed;
+
+            self.loader.waitForFinished();
+            try self.processUploads(null);
+        }
+    }
+
+    /// Uploads decoded textures until `budget_ns` is spent, at least one per call. GL thread only.
+    ///
+    /// # Arguments
+    /// - `budget_ns`: Time uploads may take, null uploads everything that is decoded
+    pub fn processUploads(self: *TextureManager, budget_ns: ?u64) !void {
+        try self.loader.takeFinished(&self.pending_uploads, self.allocator);
+        if (self.pending_uploads.items.len == 0) return;
+
+        const start = std.time.Instant.now() catch null;
+        var uploaded: usize = 0;
+
+        for (self.pending_uploads.items) |*decoded| {
+            if (uploaded > 0) {
+                if (budget_ns) |budget| {
+                    const begin = start orelse break;
+                    const now = std.time.Instant.now() catch break;
+                    if (now.since(begin) >= budget) break;
+                }
+            }
+
+            defer decoded.deinit();
+            uploaded += 1;
+
+            self.finishLoad(decoded);
+        }
+
+        // Uploaded textures are at the front, keep the rest for next frame
+        const remaining = self.pending_uploads.items.len - uploaded;
+        std.mem.copyForwards(DecodedTexture, self.pending_uploads.items[0..remaining], self.pending_uploads.items[uploaded..]);
+        self.pending_uploads.shrinkRetainingCapacity(remaining);
+    }
+
+    /// Sets callback run on the decoding thread whenever a texture finished decoding and waits for upload,
+    /// e.g. to request a frame that uploads it
+    pub fn setOnDecoded(self: *TextureManager, callback: ?*const fn (data: ?*anyopaque) void, data: ?*anyopaque) void {
+        self.loader.on_finished = callback;
+        self.loader.on_finished_data = data;
+    }
+
+    /// Sets largest sprite side that still goes into atlas, 0 disables atlas for textures loaded from now on
+    pub fn setAtlasMaxSpriteSize(self: *TextureManager, size: u32) void {
+        self.atlas_max_sprite_size = size;
+    }
+
+    // --------------------------- HELPER FUNCTIONS --------------------------- //
+    fn request(self: *TextureManager, path: []const u8, allow_atlas: bool) !TextureRegion {
+        const asset = try self.queueLoad(path, allow_atlas, false);
+        asset.last_used_frame = self.frame_index;
+
+        return switch (asset.state) {
+            .Ready => asset.region,
+            .Loading => self.getPlaceholder(),
+            .Failed => TextureManagerError.LoadFailed,
+        };
+    }
+
+    /// Returns asset of `path`, queueing its decode if it was never requested or was evicted.
+    /// Reference is taken under lock, otherwise asset could be evicted before caller gets to it.
+    fn queueLoad(self: *TextureManager, path: []const u8, allow_atlas: bool, add_reference: bool) !*TextureAsset {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (self.textures.get(path)) |asset| {
+            if (add_reference) _ = asset.ref_count.fetchAdd(1, .monotonic);
+            return asset;
         }
 
-        const allocator = std.heap.smp_allocator;
-        var read_buffer: [zigimg.io.DEFAULT_BUFFER_SIZE]u8 = undefined;
-        const image: *zigimg.Image = allocator.create(zigimg.Image) catch unreachable;
+        const asset = try self.allocator.create(TextureAsset);
+        errdefer self.allocator.destroy(asset);
+
+        const key = try self.allocator.dupe(u8, path);
+        errdefer self.allocator.free(key);
+
+        asset.* = TextureAsset{
+            .path = key,
+            .state = .Loading,
+            .region = TextureRegion.whole(0),
+            .allow_atlas = allow_atlas,
+            .is_translucent = false,
+            .residency = null,
+            .last_used_frame = self.frame_index,
+            .ref_count = std.atomic.Value(u32).init(if (add_reference) 1 else 0),
+        };
+
+        try self.textures.put(key, asset);
+        errdefer _ = self.textures.remove(key);
+
+        try self.loader.queue(key);
+
+        if (self.evicted_paths.remove(pathHash(path))) self.reload_count += 1;
+        return asset;
+    }
+
+    fn finishLoad(self: *TextureManager, decoded: *DecodedTexture) void {
+        self.mutex.lock();
+        const asset = self.textures.get(decoded.path);
+        self.mutex.unlock();
+
+        // Assets are never removed while their decode is in flight
+        const allow_atlas = if (asset) |a| a.allow_atlas else return;
+
+        // Upload happens without lock so other threads can keep requesting textures
+        const result: anyerror!TextureRegion = if (decoded.texture) |*texture|
+            self.upload(asset.?, texture, allow_atlas)
+        else
+            decoded.err orelse error.Unexpected;
+        const is_translucent = if (decoded.texture) |texture| texture.header.is_translucent != 0 else false;
+
+        // Streamed textures keep cooked data to upload finer mips from later
+        if (asset.?.residency != null) decoded.texture = null;
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (result) |region| {
+            asset.?.region = region;
+            asset.?.is_translucent = is_translucent;
+            asset.?.state = .Ready;
+        } else |e| {
+            std.log.err("Failed to load texture {s}: {}", .{ decoded.path, e });
+            asset.?.state = .Failed;
+        }
+    }
+
+    fn upload(self: *TextureManager, asset: *TextureAsset, texture: *const CookedTexture, allow_atlas: bool) !TextureRegion {
+        const width = texture.header.width;
+        const height = texture.header.height;
+
+        // Null renderer has no pages to pack into, every texture gets a name of its own
+        const fits_atlas = allow_atlas and !GlState.get().isNull() and blk: {
+            const max_size = @min(self.atlas_max_sprite_size, self.atlas.getMaxSpriteSize());
+            break :blk width <= max_size and height <= max_size;
+        };
+
+        // Atlas pages have no mips of their own, only full size level is needed
+        if (fits_atlas) return self.atlas.add(texture.getMip(0).pixels, width, height);
+
+        // Texture first shows up with its coarse levels, finer ones are streamed in once it is drawn
+        try self.streamed.append(self.allocator, asset);
+
+        const level = getCoarsestResidentLevel(texture);
+        asset.residency = MipResidency{
+            .cooked = texture.*,
+            .resident_level = level,
+            .screen_size = 0.0,
+        };
+        self.streamed_bytes += getResidentSize(texture, level);
 
-        image.* = try zigimg.Image.fromFilePath(
-            allocator,
-            path,
-            read_buffer[0..],
-        );
+        return TextureRegion.whole(self.uploadTexture(texture, level));
+    }
 
-        try image.convert(allocator, .rgba32);
-        const pixels = image.pixels.asBytes();
-        const width = image.width;
-        const height = image.height;
+    /// Uploads mip levels from `base_level` down to 1x1, `base_level` becomes level 0 of the GL texture.
+    /// UVs are normalized, so sprites do not notice which level is the finest one.
+    /// Whole chain goes through one pixel unpack buffer so the copy into GL memory can happen asynchronously.
+    fn uploadTexture(self: *TextureManager, texture: *const CookedTexture, base_level: u32) c.GLuint {
+        if (GlState.get().isNull()) return GlState.get().createNullName();
 
         var tex: c.GLuint = 0;
         c.glGenTextures(1, &tex);
-        c.glBindTexture(c.GL_TEXTURE_2D, tex);
-        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MIN_FILTER, c.GL_LINEAR);
-        c.glTexImage2D(c.GL_TEXTURE_2D, 0, c.GL_RGBA, @intCast(width), @intCast(height), 0, c.GL_RGBA, c.GL_UNSIGNED_BYTE, pixels.ptr);
+        GlState.get().bindTexture2D(0, tex);
+
+        const mip_count = texture.header.mip_count;
+        const min_filter: c.GLint = if (mip_count - base_level > 1) c.GL_LINEAR_MIPMAP_LINEAR else c.GL_LINEAR;
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MIN_FILTER, min_filter);
+
+        const base_offset = texture.getMip(base_level).offset;
+        const is_staged = self.stagePixels(texture.getPayload()[base_offset..]);
+
+        for (base_level..mip_count) |level| {
+            const mip = texture.getMip(@intCast(level));
+
+            // With an unpack buffer bound the pointer argument is an offset into it
+            const source: ?*const anyopaque = if (is_staged) @ptrFromInt(mip.offset - base_offset) else mip.pixels.ptr;
+            c.glTexImage2D(c.GL_TEXTURE_2D, @intCast(level - base_level), c.GL_RGBA, @intCast(mip.width), @intCast(mip.height), 0, c.GL_RGBA, c.GL_UNSIGNED_BYTE, source);
+        }
+
+        if (is_staged) c.glBindBuffer(c.GL_PIXEL_UNPACK_BUFFER, 0);
 
-        self.textures.put(path, tex) catch unreachable;
         return tex;
     }
+
+    /// Replaces GL texture of `asset` with one whose finest level is `level`
+    fn setResidentLevel(self: *TextureManager, asset: *TextureAsset, level: u32) void {
+        const residency = &asset.residency.?;
+        if (residency.resident_level == level) return;
+
+        const texture = self.uploadTexture(&residency.cooked, level);
+        GlState.get().deleteTexture(asset.region.texture);
+
+        self.streamed_bytes -= getResidentSize(&residency.cooked, residency.resident_level);
+        self.streamed_bytes += getResidentSize(&residency.cooked, level);
+
+        residency.resident_level = level;
+        asset.region = TextureRegion.whole(texture);
+    }
+
+    /// Drops finest level of the texture drawn longest ago that still has levels to drop
+    ///
+    /// # Returns
+    /// - `bool`: False if every texture is down to its coarse levels
+    fn dropLeastRecentlyUsed(self: *TextureManager) bool {
+        var victim: ?*TextureAsset = null;
+        var oldest_frame: u64 = std.math.maxInt(u64);
+
+        for (self.streamed.items) |asset| {
+            const residency = &asset.residency.?;
+            if (residency.resident_level >= getCoarsestResidentLevel(&residency.cooked)) continue;
+
+            if (asset.last_used_frame < oldest_frame) {
+                victim = asset;
+                oldest_frame = asset.last_used_frame;
+            }
+        }
+
+        const asset = victim orelse return false;
+        self.setResidentLevel(asset, asset.residency.?.resident_level + 1);
+
+        return true;
+    }
+
+    /// Fills `eviction_candidates` with unreferenced, loaded assets, drawn longest ago first
+    ///
+    /// # Arguments
+    /// - `only_freeing`: Skips assets whose eviction frees no GPU memory, failed loads and atlas sprites sharing a page
+    fn collectEvictionCandidates(self: *TextureManager, only_freeing: bool) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.eviction_candidates.clearRetainingCapacity();
+        self.eviction_candidates.ensureTotalCapacity(self.allocator, self.textures.count()) catch |e| {
+            std.log.warn("Skipping texture eviction: {}", .{e});
+            return;
+        };
+
+        var it = self.textures.valueIterator();
+        while (it.next()) |asset_ptr| {
+            const asset = asset_ptr.*;
+
+            // Loader still borrows path of loading assets
+            if (asset.state == .Loading or asset.ref_count.load(.acquire) != 0) continue;
+
+            if (only_freeing) {
+                if (asset.state == .Failed) continue;
+                if (asset.residency == null and !self.atlas.isLastOnPage(asset.region)) continue;
+            }
+
+            self.eviction_candidates.appendAssumeCapacity(asset);
+        }
+
+        std.mem.sort(*TextureAsset, self.eviction_candidates.items, {}, isUsedEarlier);
+    }
+
+    fn isUsedEarlier(_: void, a: *TextureAsset, b: *TextureAsset) bool {
+        return a.last_used_frame < b.last_used_frame;
+    }
+
+    /// Frees GL texture or atlas space, cooked data and asset itself
+    fn evict(self: *TextureManager, asset: *TextureAsset) void {
+        {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            // Handle may have been acquired since asset was picked
+            if (asset.ref_count.load(.acquire) != 0) return;
+
+            _ = self.textures.remove(asset.path);
+            self.evicted_paths.put(pathHash(asset.path), {}) catch {};
+        }
+
+        if (asset.residency) |*residency| {
+            GlState.get().deleteTexture(asset.region.texture);
+            self.streamed_bytes -= getResidentSize(&residency.cooked, residency.resident_level);
+            residency.cooked.deinit(texture_loader.decode_allocator);
+
+            for (self.streamed.items, 0..) |streamed, i| {
+                if (streamed == asset) {
+                    _ = self.streamed.swapRemove(i);
+                    break;
+                }
+            }
+        } else if (asset.state == .Ready) {
+            self.atlas.release(asset.region);
+        }
+
+        self.eviction_count += 1;
+        self.allocator.free(asset.path);
+        self.allocator.destroy(asset);
+    }
+
+    /// Copies pixels into pixel unpack buffer and leaves it bound
+    ///
+    /// # Returns
+    /// - `bool`: False if pixel buffers are not supported, nothing is bound then
+    fn stagePixels(self: *TextureManager, pixels: []const u8) bool {
+        if (c.GLAD_GL_VERSION_3_0 == 0) return false;
+
+        if (self.pixel_buffer == 0) c.glGenBuffers(1, &self.pixel_buffer);
+        c.glBindBuffer(c.GL_PIXEL_UNPACK_BUFFER, self.pixel_buffer);
+
+        // Orphaned every upload so a previous transfer still in flight never blocks the copy
+        c.glBufferData(c.GL_PIXEL_UNPACK_BUFFER, @intCast(pixels.len), null, c.GL_STREAM_DRAW);
+
+        const access = c.GL_MAP_WRITE_BIT | c.GL_MAP_INVALIDATE_BUFFER_BIT;
+        const ptr = c.glMapBufferRange(c.GL_PIXEL_UNPACK_BUFFER, 0, @intCast(pixels.len), access);
+        if (ptr) |destination| {
+            @memcpy(@as([*]u8, @ptrCast(destination))[0..pixels.len], pixels);
+            _ = c.glUnmapBuffer(c.GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            c.glBufferSubData(c.GL_PIXEL_UNPACK_BUFFER, 0, @intCast(pixels.len), pixels.ptr);
+        }
+
+        return true;
+    }
+
+    fn getPlaceholder(self: *TextureManager) TextureRegion {
+        if (self.placeholder.texture != 0) return self.placeholder;
+
+        if (GlState.get().isNull()) {
+            self.placeholder = TextureRegion.whole(GlState.get().createNullName());
+            return self.placeholder;
+        }
+
+        var tex: c.GLuint = 0;
+        c.glGenTextures(1, &tex);
+        GlState.get().bindTexture2D(0, tex);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MIN_FILTER, c.GL_NEAREST);
+        c.glTexParameteri(c.GL_TEXTURE_2D, c.GL_TEXTURE_MAG_FILTER, c.GL_NEAREST);
+        c.glPixelStorei(c.GL_UNPACK_ALIGNMENT, 1);
+        c.glTexImage2D(c.GL_TEXTURE_2D, 0, c.GL_RGBA, 2, 2, 0, c.GL_RGBA, c.GL_UNSIGNED_BYTE, &placeholder_pixels);
+
+        self.placeholder = TextureRegion.whole(tex);
+        return self.placeholder;
+    }
+
+    /// Finest level whose texels are not smaller than the pixels sprite covers on screen
+    fn getWantedLevel(residency: *const MipResidency) u32 {
+        const coarsest = getCoarsestResidentLevel(&residency.cooked);
+        if (residency.screen_size <= 0.0) return coarsest;
+
+        const header = residency.cooked.header;
+        const texture_size: f32 = @floatFromInt(@max(header.width, header.height));
+        if (residency.screen_size >= texture_size) return 0;
+
+        const level: u32 = @intFromFloat(@floor(std.math.log2(texture_size / residency.screen_size)));
+        return @min(level, coarsest);
+    }
+
+    /// Finest level that fits into `min_resident_size`, or the last level of small textures
+    fn getCoarsestResidentLevel(texture: *const CookedTexture) u32 {
+        const size = @max(texture.header.width, texture.header.height);
+
+        var level: u32 = 0;
+        var level_size = size;
+        while (level_size > min_resident_size and level + 1 < texture.header.mip_count) : (level += 1) {
+            level_size = @max(1, level_size / 2);
+        }
+
+        return level;
+    }
+
+    /// GPU bytes taken by levels from `level` down to 1x1
+    fn getResidentSize(texture: *const CookedTexture, level: u32) usize {
+        return texture.getPayload().len - texture.getMip(level).offset;
+    }
+};
+
+pub const TextureManagerError = error{
+    LoadFailed,
 };
@@ -12,7 +12,8 @@ pub const Renderer = enum {
     x11,
     win32,
     cocoa,
-    null,
+    headless, // Offscreen EGL, see `Headless`
+    null, // No GL at all, see `NullPlatform`
 };
 
 pub const current_platform: Platform = p: {
@@ -22,12 +23,38 @@ pub const current_platform: Platform = p: {
     break :p .unknown;
 };
 
+/// Value of environment variable `name`, null when it is not set. Unlike `std.posix.getenv()` it also compiles on Windows.
+/// Caller owns returned memory.
+pub fn getEnvOwned(allocator: std.mem.Allocator, name: []const u8) ?[]u8 {
+    return std.process.getEnvVarOwned(allocator, name) catch |e| switch (e) {
+        error.EnvironmentVariableNotFound => null,
+        else => {
+            std.log.warn("Failed to read {s}: {}", .{ name, e });
+            return null;
+        },
+    };
+}
+
+/// Environment variable that overrides detected renderer, e.g. `GLAZE_RENDERER=headless` or `GLAZE_RENDERER=null`
+pub const renderer_env_var = "GLAZE_RENDERER";
+
+/// Renderer named by `renderer_env_var`, or the one native to this platform.
+/// Windows only supports `win32` and `null`, `headless` needs EGL and is Linux only.
 pub fn detectRenderer() Renderer {
+    const allocator = std.heap.c_allocator;
+    if (getEnvOwned(allocator, renderer_env_var)) |name| {
+        defer allocator.free(name);
+
+        if (std.meta.stringToEnum(Renderer, name)) |renderer| return renderer;
+        std.log.warn("Unknown {s}={s}, detecting renderer instead", .{ renderer_env_var, name });
+    }
+
     return switch (current_platform) {
         .linux => r: {
             if (std.posix.getenv("WAYLAND_DISPLAY")) |_| break :r .wayland;
             if (std.posix.getenv("DISPLAY")) |_| break :r .x11;
-            break :r .null;
+            // No display server, e.g. a build machine
+            break :r .headless;
         },
         .windows => .win32,
         .macos => .cocoa,